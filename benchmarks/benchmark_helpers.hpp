@@ -0,0 +1,57 @@
+//
+// Small helpers shared by the microbenchmarks.
+// We do not want to pull a benchmarking library for a handful of throughput numbers,
+// so each benchmark is just a timed loop over a big random buffer.
+//
+
+#ifndef BENCHMARK_HELPERS_HPP
+#define BENCHMARK_HELPERS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace benchmark_helpers
+{
+    /**
+     * Creates a buffer of `size` pseudo-random bytes.
+     * The seed is fixed so that every run (and every benchmark) sees the same input.
+     * @param size Length of the buffer.
+     * @return Random bytes.
+     */
+    inline auto random_bytes(std::size_t size) -> std::string
+    {
+        auto generator = std::mt19937_64{ 42 };
+        auto result = std::string(size, '\0');
+        for (auto& byte : result)
+            byte = static_cast<char>(generator());
+        return result;
+    }
+
+    /**
+     * Runs `function` once and prints how many bytes per second it processed.
+     * @param name Name to show for this measurement.
+     * @param processed_bytes How many bytes `function` goes through.
+     * @param function Code to be measured. Should return something depending on the work done, so that the
+     * compiler can not throw the work away.
+     */
+    template <typename Function>
+    auto measure_throughput(std::string_view name, std::size_t processed_bytes, Function&& function) -> void
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto checksum = function();
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto seconds = std::chrono::duration<double>(end - start).count();
+        const auto megabytes_per_second = static_cast<double>(processed_bytes) / seconds / 1e6;
+        std::cout << std::left << std::setw(64) << name << std::right << std::setw(10) << std::fixed
+                  << std::setprecision(1) << megabytes_per_second << " MB/s"
+                  << "   (checksum " << static_cast<uint64_t>(checksum) << ")\n";
+    }
+} // namespace benchmark_helpers
+
+#endif // BENCHMARK_HELPERS_HPP
@@ -0,0 +1,32 @@
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+#include "../rolling_hash/cpu_dispatch.hpp"
+
+auto main(int argc, const char* argv[]) -> int
+{
+    // Numbers are only meaningful for optimized builds, e.g.
+    // cmake -DCMAKE_BUILD_TYPE=Release ..
+    const auto groups = std::vector<std::pair<std::string, std::function<void()>>>{
+        { "rolling_hash", benchmarks::run_rolling_hash_benchmarks },
+        { "file_diff", benchmarks::run_file_diff_benchmarks },
+    };
+
+    // Set ROLLING_HASH_ISA to compare the kernels of another level
+    std::cout << "ISA level: " << cpu_dispatch::isa_level_to_string(cpu_dispatch::get_active_isa_level()) << '\n';
+
+    // Optionally, only run the groups whose name contains the first argument
+    const auto filter = argc > 1 ? std::string{ argv[1] } : std::string{};
+    for (const auto& [name, run] : groups)
+    {
+        if (name.find(filter) == std::string::npos)
+            continue;
+        std::cout << "*** " << name << " ***\n";
+        run();
+    }
+}
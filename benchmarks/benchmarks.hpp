@@ -0,0 +1,14 @@
+//
+// Each file under benchmarks/ exposes one group of measurements here.
+//
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+namespace benchmarks
+{
+    auto run_rolling_hash_benchmarks() -> void;
+    auto run_file_diff_benchmarks() -> void;
+} // namespace benchmarks
+
+#endif // BENCHMARKS_HPP
@@ -0,0 +1,172 @@
+#include "benchmark_helpers.hpp"
+#include "benchmarks.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+#include "../file_diff/file_diff.hpp"
+
+namespace benchmarks
+{
+    auto run_file_diff_benchmarks() -> void
+    {
+        using benchmark_helpers::measure_throughput;
+        const auto basis = benchmark_helpers::random_bytes(std::size_t{ 1 } << 24);
+        // Same content, shifted by a few bytes, so that the delta is mostly chunk matches
+        const auto edited = "shifted" + basis;
+        const auto chunk_size = std::size_t{ 1024 };
+
+        // 1000 goes through the generic polynomial hash, 1024 through the one specialized for its size
+        for (const auto signature_chunk_size : { std::size_t{ 1000 }, std::size_t{ 1024 } })
+        {
+            for (const auto weak_hash :
+                 { FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync, FileDiff::WeakHash::rabin,
+                   FileDiff::WeakHash::crc32c })
+            {
+                const auto name = "compute_signature, " + FileDiff::weak_hash_to_string(weak_hash) + ", chunk " +
+                                  std::to_string(signature_chunk_size);
+                measure_throughput(name, std::size(basis),
+                                   [&]
+                                   {
+                                       const auto signature =
+                                           FileDiff::compute_signature(basis, signature_chunk_size, weak_hash);
+                                       return signature.rolling_hashes.back();
+                                   });
+            }
+        }
+
+        // The strong hash of every chunk: libstdc++'s std::hash is MurmurHash2, 8 bytes at a time, while XXH3 works on
+        // 64-byte stripes with SIMD. Content-defined chunks have no weak hash to hide the difference.
+        for (const auto strong_hash : { FileDiff::StrongHash::std_hash, FileDiff::StrongHash::xxh3_128 })
+        {
+            const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size, strong_hash);
+            const auto suffix = ", cdc chunks, " + FileDiff::strong_hash_to_string(strong_hash) + " strong hash";
+            measure_throughput("compute_signature" + suffix, std::size(basis),
+                               [&]
+                               {
+                                   const auto signature =
+                                       FileDiff::compute_signature(basis, context, FileDiff::Chunking::cdc);
+                                   return signature.strong_hashes.back().low;
+                               });
+            const auto signature = FileDiff::compute_signature(basis, context, FileDiff::Chunking::cdc);
+            measure_throughput("compute_delta" + suffix, std::size(edited),
+                               [&] { return std::size(FileDiff::compute_delta(edited, signature, context)); });
+        }
+
+        // Streamed a buffer at a time, which should cost no more than signing the input already in memory
+        {
+            const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size);
+            measure_throughput("compute_signature, in memory", std::size(basis),
+                               [&] { return FileDiff::compute_signature(basis, context).rolling_hashes.back(); });
+            auto stream = std::istringstream{ basis };
+            measure_throughput("compute_signature, streamed", std::size(basis),
+                               [&]
+                               {
+                                   auto last_hash = FileDiff::Hash{};
+                                   FileDiff::compute_signature(stream, context, FileDiff::Chunking::fixed,
+                                                               [&last_hash](const FileDiff::Signature& chunks)
+                                                               { last_hash = chunks.rolling_hashes.back(); });
+                                   return last_hash;
+                               });
+        }
+
+        const auto hardware_threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        for (const auto weak_hash : { FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync })
+        {
+            for (const auto threads : { std::size_t{ 1 }, std::size_t{ 2 }, std::size_t{ 4 }, hardware_threads })
+            {
+                const auto name = "compute_signature, " + FileDiff::weak_hash_to_string(weak_hash) + ", " +
+                                  std::to_string(threads) + " thread(s)";
+                measure_throughput(name, std::size(basis),
+                                   [&]
+                                   {
+                                       const auto signature = FileDiff::compute_signature(
+                                           basis, chunk_size, weak_hash, FileDiff::Chunking::fixed, threads);
+                                       return signature.rolling_hashes.back();
+                                   });
+            }
+            const auto signature = FileDiff::compute_signature(basis, chunk_size, weak_hash);
+            for (const auto threads : { std::size_t{ 1 }, std::size_t{ 2 }, std::size_t{ 4 }, hardware_threads })
+            {
+                const auto name = "compute_delta, " + FileDiff::weak_hash_to_string(weak_hash) + ", " +
+                                  std::to_string(threads) + " thread(s)";
+                measure_throughput(name, std::size(edited),
+                                   [&]
+                                   {
+                                       return std::size(
+                                           FileDiff::compute_delta(edited, signature, chunk_size, threads));
+                                   });
+            }
+        }
+
+        // Content-defined chunks: cutting them is a Gear hash per byte, and the delta matches them whole by strong
+        // hash instead of sliding a weak hash over every offset
+        for (const auto chunking : { FileDiff::Chunking::fixed, FileDiff::Chunking::cdc })
+        {
+            const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size);
+            const auto suffix = ", " + FileDiff::chunking_to_string(chunking) + " chunks";
+            measure_throughput("compute_signature" + suffix, std::size(basis),
+                               [&]
+                               {
+                                   const auto signature = FileDiff::compute_signature(basis, context, chunking);
+                                   return signature.strong_hashes.back().low;
+                               });
+            const auto signature = FileDiff::compute_signature(basis, context, chunking);
+            measure_throughput("compute_delta" + suffix, std::size(edited),
+                               [&] { return std::size(FileDiff::compute_delta(edited, signature, context)); });
+        }
+
+        // Line-edited text, as in logs or source trees: a few lines out of every hundred get longer. Compares how
+        // many bytes each chunking sends as literals.
+        auto lines = std::string{};
+        auto edited_lines = std::string{};
+        const auto line_bytes = benchmark_helpers::random_bytes(std::size_t{ 1 } << 16);
+        for (std::size_t i = 0; std::size(lines) < (std::size_t{ 1 } << 20); ++i)
+        {
+            const auto line = "2024-01-01 12:00:" + std::to_string(i % 60) + " INFO request " + std::to_string(i) +
+                              " took " + std::to_string(static_cast<unsigned char>(line_bytes[i % 65536])) + "ms\n";
+            lines += line;
+            edited_lines += i % 100 < 3 ? "(retried) " + line : line;
+        }
+        for (const auto chunking : { FileDiff::Chunking::fixed, FileDiff::Chunking::cdc, FileDiff::Chunking::lines })
+        {
+            const auto line_chunk_size = std::size_t{ 256 };
+            const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, line_chunk_size);
+            const auto signature = FileDiff::compute_signature(lines, context, chunking);
+            const auto name = "compute_delta on lines, " + FileDiff::chunking_to_string(chunking) + " chunks";
+            const auto delta = FileDiff::compute_delta(edited_lines, signature, context);
+            measure_throughput(name, std::size(edited_lines),
+                               [&] { return std::size(FileDiff::compute_delta(edited_lines, signature, context)); });
+            std::cout << "    " << std::count(std::begin(delta), std::end(delta), 'b') << " literal bytes, "
+                      << std::size(signature.strong_hashes) << " chunks in the signature\n";
+        }
+
+        // How many windows each weak hash lets through to the strong hash, on low-entropy, text-like data where
+        // weak hashes collide the most. Every 100th byte is edited, so that most windows do not match.
+        auto text = benchmark_helpers::random_bytes(std::size_t{ 1 } << 20);
+        for (auto& byte : text)
+            byte = "etaoin shrdlu"[static_cast<unsigned char>(byte) % 13];
+        auto edited_text = text;
+        for (std::size_t i = 0; i < std::size(edited_text); i += 100)
+            edited_text[i] = 'x';
+        const auto text_chunk_size = std::size_t{ 64 };
+        for (const auto weak_hash : { FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync,
+                                      FileDiff::WeakHash::buzhash, FileDiff::WeakHash::rabin,
+                                      FileDiff::WeakHash::double_polynomial, FileDiff::WeakHash::crc32c })
+        {
+            const auto context = FileDiff::HashContext(weak_hash, text_chunk_size);
+            const auto signature = FileDiff::compute_signature(text, context);
+            auto statistics = FileDiff::DeltaStatistics{};
+            const auto name = "compute_delta on text, " + FileDiff::weak_hash_to_string(weak_hash);
+            measure_throughput(name, std::size(edited_text),
+                               [&]
+                               {
+                                   return std::size(
+                                       FileDiff::compute_delta(edited_text, signature, context, 1, &statistics));
+                               });
+            std::cout << "    " << statistics.verifications_per_megabyte() << " strong hash verifications per MB, "
+                      << statistics.false_weak_matches << " weak hash collisions\n";
+        }
+    }
+} // namespace benchmarks
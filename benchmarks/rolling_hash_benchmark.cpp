@@ -0,0 +1,162 @@
+#include "benchmark_helpers.hpp"
+#include "benchmarks.hpp"
+
+#include <algorithm>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../rolling_hash/buzhash.hpp"
+#include "../rolling_hash/crc32c_hash.hpp"
+#include "../rolling_hash/double_polynomial_hash.hpp"
+#include "../rolling_hash/fixed_window_polynomial_hash.hpp"
+#include "../rolling_hash/interleaved_rolling_hash.hpp"
+#include "../rolling_hash/polynomial_hash.hpp"
+#include "../rolling_hash/rabin_fingerprint.hpp"
+#include "../rolling_hash/rolling_checksum.hpp"
+#include "../rolling_hash/rolling_checksum_kernels.hpp"
+#include "../rolling_hash/rolling_hash.hpp"
+
+namespace benchmarks
+{
+    auto run_rolling_hash_benchmarks() -> void
+    {
+        using benchmark_helpers::measure_throughput;
+        const auto input = benchmark_helpers::random_bytes(std::size_t{ 1 } << 26);
+        const auto base = uint64_t{ 257 };
+        const auto modulo = static_cast<uint64_t>(1e9 + 7);
+        const auto mersenne_modulo = PolynomialHash::mersenne_modulo;
+
+        for (const auto window_size : { std::size_t{ 30 }, std::size_t{ 4096 } })
+        {
+            const auto suffix = " (window " + std::to_string(window_size) + ")";
+            const auto slides = std::size(input) - window_size;
+
+            // Slides through the whole input, writing the hashes block by block into a buffer that stays in cache:
+            // once calling `slide_window()` and `get_current_hash()` per byte, once with `slide_many()`, and once
+            // with several windows sliding in lockstep (`hash_windows()`)
+            auto measure_view = [&](const std::string& name, auto policy)
+            {
+                auto block = std::vector<uint64_t>(std::size_t{ 1 } << 16);
+                measure_throughput(name + ", view, per byte" + suffix, slides,
+                                   [&]
+                                   {
+                                       auto hasher = RollingHash(policy, input, 0);
+                                       auto checksum = hasher.get_current_hash();
+                                       for (auto left = slides; left > 0;)
+                                       {
+                                           const auto count = std::min(left, std::size(block));
+                                           for (std::size_t i = 0; i < count; ++i)
+                                           {
+                                               hasher.slide_window();
+                                               block[i] = hasher.get_current_hash();
+                                           }
+                                           checksum += block[count - 1];
+                                           left -= count;
+                                       }
+                                       return checksum;
+                                   });
+                measure_throughput(name + ", view, slide_many" + suffix, slides,
+                                   [&]
+                                   {
+                                       auto hasher = RollingHash(policy, input, 0);
+                                       auto checksum = hasher.get_current_hash();
+                                       for (auto left = slides; left > 0;)
+                                       {
+                                           const auto count = std::min(left, std::size(block));
+                                           hasher.slide_many(std::span{ block }.first(count));
+                                           checksum += block[count - 1];
+                                           left -= count;
+                                       }
+                                       return checksum;
+                                   });
+                measure_throughput(name + ", view, " + std::to_string(get_interleaved_lanes<decltype(policy)>()) +
+                                       " interleaved" + suffix,
+                                   slides,
+                                   [&]
+                                   {
+                                       const auto first_window = std::string_view{ input }.substr(0, window_size);
+                                       auto checksum = compute_window_hash(policy, first_window);
+                                       for (std::size_t start = 1; start <= slides;)
+                                       {
+                                           const auto count = std::min(slides - start + 1, std::size(block));
+                                           const auto block_input =
+                                               std::string_view{ input }.substr(start, count + window_size - 1);
+                                           hash_windows(policy, block_input, std::span{ block }.first(count));
+                                           checksum += block[count - 1];
+                                           start += count;
+                                       }
+                                       return checksum;
+                                   });
+            };
+
+            measure_throughput("PolynomialHash, modulo 1e9+7, owned window" + suffix, slides,
+                               [&]
+                               {
+                                   const auto first_window = std::string_view{ input }.substr(0, window_size);
+                                   auto hasher = RollingHash(base, modulo, window_size, first_window);
+                                   auto checksum = hasher.get_current_hash();
+                                   for (auto i = window_size; i < std::size(input); ++i)
+                                   {
+                                       hasher.slide_window(input[i]);
+                                       checksum ^= hasher.get_current_hash();
+                                   }
+                                   return checksum;
+                               });
+            measure_view("PolynomialHash, modulo 1e9+7", PolynomialHash(base, modulo, window_size));
+            measure_view("PolynomialHash, modulo 2^61 - 1", PolynomialHash(base, mersenne_modulo, window_size));
+            if (window_size == 4096)
+                measure_view("FixedWindowPolynomialHash", FixedWindowPolynomialHash<257, 4096>{});
+            measure_view("DoublePolynomialHash", DoublePolynomialHash(window_size));
+            measure_view("RollingChecksum (rsync)", RollingChecksum(window_size));
+            // Writing 8 bytes of hash per input byte is bound by memory bandwidth, so the kernels are compared on a
+            // small input that stays in cache, hashed many times
+            const auto cached_input = std::string_view{ input }.substr(0, window_size + (std::size_t{ 1 } << 14));
+            const auto repetitions = std::size(input) / std::size(cached_input);
+            auto output = std::vector<uint64_t>(std::size(cached_input) - window_size + 1);
+            using rolling_checksum_kernels::Kernel;
+            const auto kernels = { std::pair{ "scalar", Kernel::scalar }, std::pair{ "SSE4.1", Kernel::sse41 },
+                                   std::pair{ "AVX2", Kernel::avx2 }, std::pair{ "AVX-512", Kernel::avx512 } };
+            for (const auto& [name, kernel] : kernels)
+            {
+                if (!rolling_checksum_kernels::is_supported(kernel))
+                    continue;
+                measure_throughput(std::string{ "RollingChecksum (rsync), in cache, " } + name + suffix,
+                                   repetitions * std::size(output),
+                                   [&]
+                                   {
+                                       auto checksum = uint64_t{};
+                                       for (std::size_t i = 0; i < repetitions; ++i)
+                                       {
+                                           rolling_checksum_kernels::hash_all_windows(cached_input, window_size,
+                                                                                      output, kernel);
+                                           checksum += output.back();
+                                       }
+                                       return checksum;
+                                   });
+            }
+            measure_view("Buzhash", Buzhash(window_size));
+            measure_view("RabinFingerprint",
+                         RabinFingerprint(RabinFingerprint::default_polynomial, window_size));
+            measure_view("Crc32cHash", Crc32cHash(window_size));
+            // Whole windows, one after the other, as the signature hashes its chunks
+            for (const auto hardware : { false, true })
+            {
+                if (hardware && !Crc32cHash::is_hardware_supported())
+                    continue;
+                const auto policy = Crc32cHash(window_size, hardware);
+                measure_throughput(std::string{ "Crc32cHash, whole windows, " } + (hardware ? "crc32" : "table") +
+                                       suffix,
+                                   std::size(input),
+                                   [&]
+                                   {
+                                       const auto view = std::string_view{ input };
+                                       auto checksum = uint64_t{};
+                                       for (std::size_t i = 0; i + window_size <= std::size(view); i += window_size)
+                                           checksum ^= policy.hash_window(view.substr(i, window_size));
+                                       return checksum;
+                                   });
+            }
+        }
+    }
+} // namespace benchmarks
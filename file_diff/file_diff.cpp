@@ -3,125 +3,467 @@
 //
 
 #include "file_diff.hpp"
+#include "../rolling_hash/fastcdc.hpp"
+#include "../rolling_hash/interleaved_rolling_hash.hpp"
+#include "../rolling_hash/line_chunking.hpp"
+#include "../rolling_hash/rolling_checksum_kernels.hpp"
 #include "../rolling_hash/rolling_hash.hpp"
 
+// Every xxHash function is inlined here, so that it needs no translation unit of its own
+#define XXH_INLINE_ALL
+#include "../third_party/xxhash/xxhash.h"
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
 #include <map>
+#include <span>
+#include <stdexcept>
+#include <thread>
 
-auto FileDiff::compute_signature(const std::string& input_string, const std::size_t chunk_size) -> Signature
+namespace
 {
-    const auto chunks = split_into_chunks(input_string, chunk_size);
+    // Below this many windows per thread, starting the thread costs more than hashing its windows. Hashing a whole
+    // chunk costs about as much as sliding over as many windows as it has bytes.
+    constexpr std::size_t minimum_windows_per_thread = 1 << 16;
 
-    auto result = Signature{};
-    result.rolling_hashes.reserve(std::size(chunks));
-    result.strong_hashes.reserve(std::size(chunks));
-    for (const auto& chunk : chunks)
+    // Most windows hashed ahead at once through unmatched bytes, when computing a delta on a single thread. Their
+    // hashes then stay in the cache.
+    constexpr std::size_t maximum_delta_block_size = 1 << 14;
+
+    /**
+     * Splits [0, `count`) into contiguous segments and calls `function(begin, end)` for each one of them.
+     * \n
+     * Segments run concurrently, one per thread, the last one on the calling thread. There are at most
+     * `threads` segments, and fewer if they would be shorter than `minimum_segment_size`.
+     * @param count Number of items to split.
+     * @param threads Maximum number of threads to use.
+     * @param minimum_segment_size Fewest items worth a thread.
+     * @param function Callable taking the [begin, end) range of a segment.
+     */
+    template <typename Function>
+    auto for_each_segment(std::size_t count, std::size_t threads, std::size_t minimum_segment_size,
+                          Function&& function) -> void
+    {
+        const auto maximum_segments = std::max<std::size_t>(count / std::max<std::size_t>(minimum_segment_size, 1), 1);
+        const auto number_of_segments = std::clamp<std::size_t>(threads, 1, maximum_segments);
+        const auto segment_begin = [count, number_of_segments](std::size_t segment)
+        { return count * segment / number_of_segments; };
+
+        auto workers = std::vector<std::jthread>{};
+        workers.reserve(number_of_segments - 1);
+        for (std::size_t segment = 0; segment + 1 < number_of_segments; ++segment)
+        {
+            workers.emplace_back([&function, begin = segment_begin(segment), end = segment_begin(segment + 1)]
+                                 { function(begin, end); });
+        }
+        function(segment_begin(number_of_segments - 1), count);
+        // The workers are joined when leaving the scope
+    }
+} // namespace
+
+FileDiff::HashContext::HashContext(const WeakHash weak_hash, const std::size_t chunk_size, const StrongHash strong_hash)
+    : m_weak_hash{ weak_hash }, m_strong_hash{ strong_hash }, m_chunk_size{ chunk_size },
+      m_policy{ make_policy(weak_hash, chunk_size) }
+{
+}
+
+auto FileDiff::HashContext::make_policy(const WeakHash weak_hash, const std::size_t chunk_size) -> Policy
+{
+    switch (weak_hash)
     {
-        result.rolling_hashes.push_back(compute_single_rolling_hash(chunk));
-        result.strong_hashes.push_back(compute_strong_hash(chunk));
+    case WeakHash::polynomial:
+        static_assert(m_rolling_hash_modulo == PolynomialHash::mersenne_modulo);
+        switch (chunk_size)
+        {
+        case 512:
+            return FixedWindowHash<512>{};
+        case 1024:
+            return FixedWindowHash<1024>{};
+        case 2048:
+            return FixedWindowHash<2048>{};
+        case 4096:
+            return FixedWindowHash<4096>{};
+        case 8192:
+            return FixedWindowHash<8192>{};
+        default:
+            return PolynomialHash(m_rolling_hash_base, m_rolling_hash_modulo, chunk_size);
+        }
+    case WeakHash::rsync:
+        return RollingChecksum(chunk_size);
+    case WeakHash::buzhash:
+        return Buzhash(chunk_size);
+    case WeakHash::rabin:
+        return RabinFingerprint(RabinFingerprint::default_polynomial, chunk_size);
+    case WeakHash::double_polynomial:
+        return DoublePolynomialHash(chunk_size);
+    case WeakHash::crc32c:
+        return Crc32cHash(chunk_size);
     }
+    throw std::runtime_error("Unknown weak hash.");
+}
+
+auto FileDiff::get_automatic_chunk_size(const std::size_t input_size) -> std::size_t
+{
+    // Integer square root, rounded down to a power of two: the largest power of two whose square fits
+    auto result = std::size_t{ 1 };
+    while (result < maximum_automatic_chunk_size && (result * 2) * (result * 2) <= input_size)
+        result *= 2;
+    return std::clamp(result, minimum_automatic_chunk_size, maximum_automatic_chunk_size);
+}
+
+auto FileDiff::compute_signature(const std::string& input_string, const std::size_t chunk_size,
+                                 const WeakHash weak_hash, const Chunking chunking, const std::size_t threads)
+    -> Signature
+{
+    return compute_signature(input_string, HashContext(weak_hash, chunk_size), chunking, threads);
+}
+
+auto FileDiff::compute_signature(const std::string& input_string, const HashContext& context,
+                                 const Chunking chunking, const std::size_t threads) -> Signature
+{
+    const auto chunk_size = context.get_chunk_size();
+    // The chunks are hashed where they are in `input_string`
+    auto result = hash_chunks(get_chunk_views(input_string, chunk_size, chunking), context, chunking, threads);
+    result.weak_hash = context.get_weak_hash();
+    result.strong_hash = context.get_strong_hash();
+    result.chunking = chunking;
+    result.chunk_size = chunk_size;
+    if (chunking == Chunking::fixed)
+        result.tail_length = std::size(input_string) % chunk_size;
     return result;
 }
 
-auto FileDiff::compute_delta(const std::string& my_string, const Signature& signature, const std::size_t chunk_size)
-    -> Delta
+auto FileDiff::compute_signature(std::istream& input, const HashContext& context, const Chunking chunking,
+                                 const std::function<void(const Signature&)>& on_chunks, const std::size_t threads)
+    -> Signature
 {
-    // These are rolling hashes for every possible chunk (regarding shifting)
-    const auto all_hashes = compute_rolling_hashes(my_string, chunk_size);
+    const auto chunk_size = context.get_chunk_size();
+    auto result = Signature{};
+    result.weak_hash = context.get_weak_hash();
+    result.strong_hash = context.get_strong_hash();
+    result.chunking = chunking;
+    result.chunk_size = chunk_size;
 
-    auto get_hash = [&all_hashes](auto start_index)
+    // A whole number of chunks, so that fixed chunks never straddle two buffers
+    const auto buffer_size = std::max<std::size_t>(signature_buffer_size / chunk_size, 8) * chunk_size;
+    // Variable-length chunks are only cut once there are more than this many bytes from their start, so that they
+    // end where they would in the whole input: with exactly that many, the cut could not tell the end of the buffer
+    // from the end of the input. The rest is carried over to the start of the next buffer.
+    const auto lookahead = chunking == Chunking::fixed ? 0 : get_maximum_chunk_size(chunk_size, chunking);
+    assert(lookahead < buffer_size);
+    auto buffer = std::string(buffer_size, '\0');
+    auto buffered = std::size_t{};
+    auto total_size = std::size_t{};
+    for (auto at_end = false; !at_end;)
     {
-        assert(start_index < std::size(all_hashes));
-        return all_hashes.at(start_index);
-    };
+        input.read(std::data(buffer) + buffered, static_cast<std::streamsize>(buffer_size - buffered));
+        if (input.bad())
+            throw std::runtime_error("Could not read the input.");
+        const auto read = static_cast<std::size_t>(input.gcount());
+        buffered += read;
+        total_size += read;
+        // `read` only stops short of filling the buffer at the end of the input
+        at_end = buffered < buffer_size;
+
+        auto rest = std::string_view{ std::data(buffer), buffered };
+        auto chunks = std::vector<std::string_view>{};
+        if (chunking == Chunking::fixed)
+        {
+            // An empty input still has one (empty) chunk, but a full last buffer is not followed by one
+            if (buffered != 0 || total_size == 0)
+                chunks = get_chunk_views(rest, chunk_size);
+            rest = {};
+        }
+        else
+        {
+            while (!rest.empty() && (at_end || std::size(rest) > lookahead))
+            {
+                chunks.push_back(rest.substr(0, find_chunk_end(rest, chunk_size, chunking)));
+                rest.remove_prefix(std::size(chunks.back()));
+            }
+        }
+        if (!chunks.empty())
+        {
+            auto buffer_signature = hash_chunks(chunks, context, chunking, threads);
+            buffer_signature.weak_hash = result.weak_hash;
+            buffer_signature.strong_hash = result.strong_hash;
+            buffer_signature.chunking = result.chunking;
+            buffer_signature.chunk_size = result.chunk_size;
+            on_chunks(buffer_signature);
+        }
+        std::copy(std::begin(rest), std::end(rest), std::begin(buffer));
+        buffered = std::size(rest);
+    }
+    if (chunking == Chunking::fixed)
+        result.tail_length = total_size % chunk_size;
+    return result;
+}
+
+auto FileDiff::hash_chunks(const std::vector<std::string_view>& chunks, const HashContext& context,
+                           const Chunking chunking, const std::size_t threads) -> Signature
+{
+    const auto number_of_chunks = std::size(chunks);
+    const auto has_rolling_hashes = chunking == Chunking::fixed;
+    const auto strong_hash = context.get_strong_hash();
+    // Every chunk has its slots already, so that each segment of chunks fills its own, in any order, and the
+    // signature is the same with any number of threads
+    auto result = Signature{};
+    result.strong_hashes.resize(number_of_chunks);
+    (has_rolling_hashes ? result.rolling_hashes : result.chunk_lengths).resize(number_of_chunks);
+
+    auto total_size = std::size_t{};
+    for (const auto chunk : chunks)
+        total_size += std::size(chunk);
+    const auto average_chunk_size = std::max<std::size_t>(total_size / std::max<std::size_t>(number_of_chunks, 1), 1);
+    context.visit(
+        [&](const auto& policy)
+        {
+            const auto hash_segment = [&](std::size_t begin, std::size_t end)
+            {
+                for (auto chunk_id = begin; chunk_id < end; ++chunk_id)
+                {
+                    const auto chunk = chunks[chunk_id];
+                    result.strong_hashes[chunk_id] = compute_strong_hash(chunk, strong_hash);
+                    // Variable-length chunks are matched whole, without a rolling hash. The last fixed chunk may
+                    // be shorter, which the policy handles as well.
+                    if (has_rolling_hashes)
+                        result.rolling_hashes[chunk_id] = compute_window_hash(policy, chunk);
+                    else
+                        result.chunk_lengths[chunk_id] = std::size(chunk);
+                }
+            };
+            for_each_segment(number_of_chunks, threads, minimum_windows_per_thread / average_chunk_size,
+                             hash_segment);
+        });
+    return result;
+}
+
+auto FileDiff::compute_delta(const std::string& my_string, const Signature& signature, const std::size_t chunk_size,
+                             const std::size_t threads) -> Delta
+{
+    return compute_delta(my_string, signature, HashContext(signature.weak_hash, chunk_size, signature.strong_hash),
+                         threads);
+}
+
+auto FileDiff::compute_delta(const std::string& my_string, const Signature& signature, const HashContext& context,
+                             const std::size_t threads, DeltaStatistics* statistics) -> Delta
+{
+    if (context.get_weak_hash() != signature.weak_hash)
+        throw std::runtime_error("The signature was computed with another weak hash.");
+    if (context.get_strong_hash() != signature.strong_hash)
+        throw std::runtime_error("The signature was computed with another strong hash.");
+    if (signature.chunk_size != 0 && context.get_chunk_size() != signature.chunk_size)
+        throw std::runtime_error("The signature was computed with another chunk size.");
+    if (signature.chunking != Chunking::fixed)
+        return compute_variable_length_delta(my_string, signature, context, statistics);
+    const auto chunk_size = context.get_chunk_size();
+    const auto strong_hash = context.get_strong_hash();
 
     // For each "our" rolling hash, we need to know
     // 1 - Whether we have the same hash in signature
     // 2 - The associated *strong* hash in signature, if yes
     // With a map, we can answer (1) in O(log n) and keeping track
     // of the id we can answer (2) in O(1).
+    // A short last chunk is left out: it can only match at the end of `my_string`, which is checked on its own.
     const auto rolling_hash_to_id = [&signature]
     {
         const auto& rolling_hashes = signature.rolling_hashes;
         using ID = std::size_t;
         auto result = std::map<Hash, ID>{};
-        for (std::size_t i = 0; i < std::size(rolling_hashes); ++i)
+        const auto whole_chunks = std::size(rolling_hashes) - (signature.tail_length != 0 ? 1 : 0);
+        for (std::size_t i = 0; i < whole_chunks; ++i)
             result[rolling_hashes.at(i)] = i;
         return result;
     }();
 
-    auto result = Delta{};
-    for (std::size_t start = 0; start < std::size(my_string);)
+    auto delta_statistics = DeltaStatistics{};
+    delta_statistics.bytes = std::size(my_string);
+
+    // Goes through `my_string` matching chunks, for any way `get_hash(start)` of getting the rolling hash of the
+    // chunk starting at `start`. `start` only ever moves forward.
+    auto match_chunks = [&](auto&& get_hash) -> Delta
     {
-        auto add_byte = [&result, &start, &my_string]
+        auto result = Delta{};
+        for (std::size_t start = 0; start < std::size(my_string);)
         {
-            result += human_readable_byte_token;
-            result += my_string.at(start);
-            start += 1;
-        };
+            auto add_byte = [&result, &start, &my_string]
+            {
+                result += human_readable_byte_token;
+                result += my_string.at(start);
+                start += 1;
+            };
 
-        auto add_chunk_reference = [&result, &start, &chunk_size](const auto chunk_id)
-        {
-            result += human_readable_reference_token;
-            result += std::to_string(chunk_id);
-            // We have just processed all this chunk
-            start += chunk_size;
-        };
+            auto add_chunk_reference = [&result, &start](const auto chunk_id, const std::size_t length)
+            {
+                result += human_readable_reference_token;
+                result += std::to_string(chunk_id);
+                // We have just processed all this chunk
+                start += length;
+            };
 
-        // If we do not have enough characters to complete a chunk, it will not match
-        if (start + chunk_size - 1 >= std::size(my_string))
-        {
-            add_byte();
-            continue;
-        }
+            // If we do not have enough characters to complete a chunk, only the short last chunk of the signature
+            // may match, if exactly what is left has its length
+            if (start + chunk_size - 1 >= std::size(my_string))
+            {
+                const auto tail_length = signature.tail_length;
+                if (tail_length != 0 && std::size(my_string) - start == tail_length)
+                {
+                    const auto tail_id = std::size(signature.strong_hashes) - 1;
+                    ++delta_statistics.strong_hash_verifications;
+                    if (compute_strong_hash(std::string_view{ my_string }.substr(start), strong_hash) ==
+                        signature.strong_hashes.at(tail_id))
+                    {
+                        add_chunk_reference(tail_id, tail_length);
+                        continue;
+                    }
+                }
+                add_byte();
+                continue;
+            }
 
-        const auto this_hash = get_hash(start);
-        const auto where = rolling_hash_to_id.find(this_hash);
-        const auto match_rolling_hash = where != std::end(rolling_hash_to_id);
-        if (match_rolling_hash)
-        {
-            // This chunk is a potential match.
-            // To be careful with a hash collision here, we will check if the
-            // strong hash also matches (chances of collision are *very* low then)
-
-            const auto& strong_hashes = signature.strong_hashes;
-            const auto this_string = my_string.substr(start, chunk_size);
-            const auto this_strong_hash = compute_strong_hash(this_string);
-
-            // As signature is a pair of {rolling_hash, strong_hash}, we can find the
-            // candidate chunk's strong hash by the index
-            const auto [_, candidate_id] = *where;
-            const auto candidate_strong_hash = strong_hashes.at(candidate_id);
-
-            const auto is_indeed_match = this_strong_hash == candidate_strong_hash;
-            if (is_indeed_match)
-                add_chunk_reference(candidate_id);
+            const auto this_hash = get_hash(start);
+            const auto where = rolling_hash_to_id.find(this_hash);
+            const auto match_rolling_hash = where != std::end(rolling_hash_to_id);
+            if (match_rolling_hash)
+            {
+                // This chunk is a potential match.
+                // To be careful with a hash collision here, we will check if the
+                // strong hash also matches (chances of collision are *very* low then)
+
+                const auto& strong_hashes = signature.strong_hashes;
+                const auto this_string = std::string_view{ my_string }.substr(start, chunk_size);
+                const auto this_strong_hash = compute_strong_hash(this_string, strong_hash);
+
+                // As signature is a pair of {rolling_hash, strong_hash}, we can find the
+                // candidate chunk's strong hash by the index
+                const auto [_, candidate_id] = *where;
+                const auto candidate_strong_hash = strong_hashes.at(candidate_id);
+
+                const auto is_indeed_match = this_strong_hash == candidate_strong_hash;
+                ++delta_statistics.strong_hash_verifications;
+                if (is_indeed_match)
+                {
+                    add_chunk_reference(candidate_id, chunk_size);
+                }
+                else
+                {
+                    ++delta_statistics.false_weak_matches;
+                    add_byte();
+                }
+            }
             else
+            {
+                // If not even the rolling hashes matched, it's surely not the same string
                 add_byte();
+            }
         }
-        else
+        return result;
+    };
+
+    auto result = context.visit(
+        [&](const auto& policy) -> Delta
         {
-            // If not even the rolling hashes matched, it's surely not the same string
-            add_byte();
-        }
-    }
+            // With several threads, or with rsync's vectorized kernels, hashing every window up front is faster.
+            // These are rolling hashes for every possible chunk (regarding shifting)
+            if (threads > 1 || std::same_as<std::remove_cvref_t<decltype(policy)>, RollingChecksum> ||
+                std::size(my_string) < chunk_size)
+            {
+                const auto all_hashes = compute_rolling_hashes(my_string, context, threads);
+                return match_chunks(
+                    [&all_hashes](std::size_t start)
+                    {
+                        assert(start < std::size(all_hashes));
+                        return all_hashes[start];
+                    });
+            }
+
+            // Otherwise, windows are only hashed when the matching gets to them: after a matched chunk, the hasher
+            // jumps right after it instead of sliding through the `chunk_size - 1` windows in between. Runs of
+            // unmatched bytes are hashed ahead, a block of windows at a time, with interleaved hashers that overlap
+            // their updates. Blocks start small after each jump and grow while the run goes on, so that a few
+            // unmatched bytes between matched chunks do not hash many windows for nothing.
+            auto hasher = RollingHash(policy, my_string, 0);
+            const auto number_of_windows = std::size(my_string) - chunk_size + 1;
+            const auto minimum_block_size = chunk_size;
+            const auto maximum_block_size = std::max(chunk_size, maximum_delta_block_size);
+            auto block_size = minimum_block_size;
+            auto block = std::vector<Hash>{};
+            auto block_start = std::size_t{};
+            auto previous_start = std::size_t{};
+            return match_chunks(
+                [&](std::size_t start)
+                {
+                    // `start` only moves forward, so it is never before `block_start`
+                    if (start - block_start < std::size(block))
+                    {
+                        previous_start = start;
+                        return block[start - block_start];
+                    }
+                    if (start != previous_start + 1)
+                    {
+                        block_size = minimum_block_size;
+                        previous_start = start;
+                        if (start != hasher.get_window_start())
+                            hasher.reset_at(start);
+                        return hasher.get_current_hash();
+                    }
+                    block.resize(std::min(block_size, number_of_windows - start));
+                    hash_windows(policy, std::string_view{ my_string }.substr(start, std::size(block) + chunk_size - 1),
+                                 std::span{ block });
+                    block_start = start;
+                    block_size = std::min(2 * block_size, maximum_block_size);
+                    previous_start = start;
+                    return block.front();
+                });
+        });
+    if (statistics != nullptr)
+        *statistics = delta_statistics;
     return result;
 }
 
-auto FileDiff::apply_delta(const std::string& basis_string, const Delta& delta, const std::size_t chunk_size)
-    -> std::string
+auto FileDiff::compute_variable_length_delta(const std::string& my_string, const Signature& signature,
+                                             const HashContext& context, DeltaStatistics* statistics) -> Delta
 {
-    const auto chunks = split_into_chunks(basis_string, chunk_size);
-    auto result = std::string{};
-    auto parse_number = [&delta](auto start)
+    auto strong_hash_to_id = std::map<Digest, std::size_t>{};
+    for (std::size_t i = 0; i < std::size(signature.strong_hashes); ++i)
+        strong_hash_to_id[signature.strong_hashes.at(i)] = i;
+
+    auto delta_statistics = DeltaStatistics{};
+    delta_statistics.bytes = std::size(my_string);
+    const auto chunk_size = context.get_chunk_size();
+    auto result = Delta{};
+    for (auto rest = std::string_view{ my_string }; !rest.empty();)
     {
-        auto number_as_string = std::string{};
-        while (start < std::size(delta) && std::isdigit(delta.at(start)))
+        // Same boundaries as the signature's, wherever the content is the same
+        const auto chunk = rest.substr(0, find_chunk_end(rest, chunk_size, signature.chunking));
+        rest.remove_prefix(std::size(chunk));
+
+        ++delta_statistics.strong_hash_verifications;
+        const auto where = strong_hash_to_id.find(compute_strong_hash(chunk, context.get_strong_hash()));
+        if (where != std::end(strong_hash_to_id) && signature.chunk_lengths.at(where->second) == std::size(chunk))
         {
-            number_as_string.push_back(delta.at(start));
-            start += 1;
+            result += human_readable_reference_token;
+            result += std::to_string(where->second);
+            continue;
         }
-        return number_as_string;
-    };
+        for (const auto c : chunk)
+        {
+            result += human_readable_byte_token;
+            result += c;
+        }
+    }
+    if (statistics != nullptr)
+        *statistics = delta_statistics;
+    return result;
+}
+
+auto FileDiff::apply_delta(const std::string& basis_string, const Delta& delta, const std::size_t chunk_size,
+                           const Chunking chunking) -> std::string
+{
+    // Referenced chunks are copied straight from `basis_string` into the result
+    const auto chunks = get_chunk_views(basis_string, chunk_size, chunking);
+    auto result = std::string{};
     for (std::size_t current_index = 0; current_index < std::size(delta);)
     {
         // let '@' be the "reference to chunk" token
@@ -133,9 +475,12 @@ auto FileDiff::apply_delta(const std::string& basis_string, const Delta& delta,
         if (current_symbol == human_readable_reference_token)
         {
             // The next symbols represent the id of the matching chunk
-            const auto id_as_string = parse_number(current_index + 1);
-            const auto id = static_cast<std::size_t>(std::stoi(id_as_string));
-            current_index += 1 + id_as_string.length(); // Accounts for the @ and the id
+            const auto* const id_begin = std::data(delta) + current_index + 1;
+            auto id = std::size_t{};
+            const auto [id_end, error] = std::from_chars(id_begin, std::data(delta) + std::size(delta), id);
+            if (error != std::errc{})
+                throw std::runtime_error("Invalid chunk reference in the delta.");
+            current_index += 1 + static_cast<std::size_t>(id_end - id_begin); // Accounts for the @ and the id
             result += chunks.at(id);
         }
         else
@@ -149,63 +494,216 @@ auto FileDiff::apply_delta(const std::string& basis_string, const Delta& delta,
     return result;
 }
 
+auto FileDiff::get_chunk_views(const std::string_view input, const std::size_t chunk_size, const Chunking chunking)
+    -> std::vector<std::string_view>
+{
+    auto result = std::vector<std::string_view>{};
+    if (chunking != Chunking::fixed)
+    {
+        const auto lengths = get_chunk_lengths(input, chunk_size, chunking);
+        result.reserve(std::size(lengths));
+        auto chunk_start = std::size_t{};
+        for (const auto length : lengths)
+        {
+            result.push_back(input.substr(chunk_start, length));
+            chunk_start += length;
+        }
+        return result;
+    }
+
+    // An empty input still has one (empty) chunk
+    const auto number_of_chunks = std::max<std::size_t>((std::size(input) + chunk_size - 1) / chunk_size, 1);
+    result.reserve(number_of_chunks);
+    for (std::size_t chunk_id = 0; chunk_id < number_of_chunks; ++chunk_id)
+        result.push_back(input.substr(chunk_id * chunk_size, chunk_size));
+    return result;
+}
+
 // Public in order to be tested by Catch2
 auto FileDiff::split_into_chunks(const std::string& input_string, const std::size_t chunk_size)
     -> std::vector<std::string>
 {
-    if (std::size(input_string) <= chunk_size)
-        return { input_string };
+    const auto chunks = get_chunk_views(input_string, chunk_size);
+    return std::vector<std::string>(std::begin(chunks), std::end(chunks));
+}
 
-    auto result = std::vector<std::string>{};
-    auto number_of_chunks = std::size(input_string) / chunk_size;
-    if (std::size(input_string) % chunk_size != 0)
-        ++number_of_chunks;
-    result.reserve(number_of_chunks);
-    for (std::size_t current_index = 0; current_index < std::size(input_string);)
+auto FileDiff::split_into_variable_length_chunks(const std::string& input_string, const std::size_t chunk_size,
+                                                 const Chunking chunking) -> std::vector<std::string>
+{
+    const auto chunks = get_chunk_views(input_string, chunk_size, chunking);
+    return std::vector<std::string>(std::begin(chunks), std::end(chunks));
+}
+
+auto FileDiff::weak_hash_to_string(const WeakHash weak_hash) -> std::string
+{
+    switch (weak_hash)
     {
-        auto current_string = std::string{};
-        current_string.reserve(chunk_size);
-        for (std::size_t offset = 0; offset < chunk_size; ++offset)
-        {
-            if (current_index + offset >= std::size(input_string))
-                break;
-            current_string.push_back(input_string.at(current_index + offset));
-        }
-        current_index += chunk_size;
-        result.push_back(current_string);
+    case WeakHash::polynomial:
+        return "polynomial";
+    case WeakHash::rsync:
+        return "rsync";
+    case WeakHash::buzhash:
+        return "buzhash";
+    case WeakHash::rabin:
+        return "rabin";
+    case WeakHash::double_polynomial:
+        return "double-polynomial";
+    case WeakHash::crc32c:
+        return "crc32c";
     }
-    return result;
+    throw std::runtime_error("Unknown weak hash.");
+}
+
+auto FileDiff::weak_hash_from_string(const std::string& name) -> WeakHash
+{
+    for (const auto weak_hash : { WeakHash::polynomial, WeakHash::rsync, WeakHash::buzhash, WeakHash::rabin,
+                                  WeakHash::double_polynomial, WeakHash::crc32c })
+    {
+        if (weak_hash_to_string(weak_hash) == name)
+            return weak_hash;
+    }
+    throw std::runtime_error("Unknown weak hash: " + name);
 }
 
-auto FileDiff::compute_single_rolling_hash(const std::string& input) -> Hash
+auto FileDiff::strong_hash_to_string(const StrongHash strong_hash) -> std::string
 {
-    const auto chunk_size = std::size(input);
-    const auto hasher = RollingHash(m_rolling_hash_base, m_rolling_hash_modulo, chunk_size, input);
-    return hasher.get_current_hash();
+    switch (strong_hash)
+    {
+    case StrongHash::std_hash:
+        return "std";
+    case StrongHash::xxh3_128:
+        return "xxh3-128";
+    }
+    throw std::runtime_error("Unknown strong hash.");
 }
 
-auto FileDiff::compute_rolling_hashes(const std::string& input, const std::size_t chunk_size) -> std::vector<Hash>
+auto FileDiff::strong_hash_from_string(const std::string& name) -> StrongHash
 {
-    // Compute the initial window
-    if (std::size(input) < chunk_size)
-        return { compute_single_rolling_hash(input) };
+    for (const auto strong_hash : { StrongHash::std_hash, StrongHash::xxh3_128 })
+    {
+        if (strong_hash_to_string(strong_hash) == name)
+            return strong_hash;
+    }
+    throw std::runtime_error("Unknown strong hash: " + name);
+}
 
-    const auto first_chunk = input.substr(0, chunk_size);
-    auto hasher = RollingHash(m_rolling_hash_base, m_rolling_hash_modulo, chunk_size, first_chunk);
+auto FileDiff::chunking_to_string(const Chunking chunking) -> std::string
+{
+    switch (chunking)
+    {
+    case Chunking::fixed:
+        return "fixed";
+    case Chunking::cdc:
+        return "cdc";
+    case Chunking::lines:
+        return "lines";
+    }
+    throw std::runtime_error("Unknown chunking.");
+}
 
-    auto current_hash = hasher.get_current_hash();
-    auto result = std::vector<Hash>{};
-    result.push_back(current_hash);
-    for (std::size_t i = chunk_size; i < std::size(input); ++i)
+auto FileDiff::chunking_from_string(const std::string& name) -> Chunking
+{
+    for (const auto chunking : { Chunking::fixed, Chunking::cdc, Chunking::lines })
     {
-        hasher.slide_window(input.at(i));
-        result.push_back(hasher.get_current_hash());
+        if (chunking_to_string(chunking) == name)
+            return chunking;
     }
+    throw std::runtime_error("Unknown chunking: " + name);
+}
 
-    return result;
+auto FileDiff::find_chunk_end(const std::string_view input, const std::size_t chunk_size, const Chunking chunking)
+    -> std::size_t
+{
+    switch (chunking)
+    {
+    case Chunking::cdc:
+        return fastcdc::find_chunk_end(input, fastcdc::make_parameters(chunk_size));
+    case Chunking::lines:
+        return line_chunking::find_chunk_end(input, line_chunking::make_parameters(chunk_size));
+    case Chunking::fixed:
+        break;
+    }
+    throw std::runtime_error("Not a variable-length chunking.");
+}
+
+auto FileDiff::get_maximum_chunk_size(const std::size_t chunk_size, const Chunking chunking) -> std::size_t
+{
+    switch (chunking)
+    {
+    case Chunking::cdc:
+        return fastcdc::make_parameters(chunk_size).maximum_size;
+    case Chunking::lines:
+        return line_chunking::make_parameters(chunk_size).maximum_size;
+    case Chunking::fixed:
+        break;
+    }
+    throw std::runtime_error("Not a variable-length chunking.");
+}
+
+auto FileDiff::get_chunk_lengths(const std::string_view input, const std::size_t chunk_size, const Chunking chunking)
+    -> std::vector<std::size_t>
+{
+    switch (chunking)
+    {
+    case Chunking::cdc:
+        return fastcdc::split(input, fastcdc::make_parameters(chunk_size));
+    case Chunking::lines:
+        return line_chunking::split(input, line_chunking::make_parameters(chunk_size));
+    case Chunking::fixed:
+        break;
+    }
+    throw std::runtime_error("Not a variable-length chunking.");
 }
 
-auto FileDiff::compute_strong_hash(const std::string& input) -> Hash
+auto FileDiff::compute_rolling_hashes(const std::string& input, const HashContext& context,
+                                      const std::size_t threads) -> std::vector<Hash>
 {
-    return std::hash<std::string>{}(input);
+    const auto chunk_size = context.get_chunk_size();
+    return context.visit(
+        [&input, chunk_size, threads](const auto& policy) -> std::vector<Hash>
+        {
+            // Compute the initial window
+            if (std::size(input) < chunk_size)
+                return { compute_window_hash(policy, input) };
+
+            // The hashers slide directly over `input`, so the windows are never copied
+            const auto number_of_windows = std::size(input) - chunk_size + 1;
+            auto result = std::vector<Hash>(number_of_windows);
+            // Each segment of windows is hashed independently. Its first window is seeded from the
+            // `chunk_size - 1` bytes before the segment's own, so the seams between segments hash exactly
+            // as they would serially.
+            const auto hash_segment = [&](std::size_t begin, std::size_t end)
+            {
+                const auto segment_input = std::string_view{ input }.substr(begin, end - begin + chunk_size - 1);
+                const auto segment_output = std::span{ result }.subspan(begin, end - begin);
+                // rsync's checksum only needs additions, so it has vectorized kernels computing several
+                // windows at once.
+                if constexpr (std::same_as<std::remove_cvref_t<decltype(policy)>, RollingChecksum>)
+                {
+                    rolling_checksum_kernels::hash_all_windows(segment_input, chunk_size, segment_output);
+                }
+                else
+                {
+                    // Otherwise, several windows slide in lockstep, so that their updates overlap
+                    hash_windows(policy, segment_input, segment_output);
+                }
+            };
+            for_each_segment(number_of_windows, threads, minimum_windows_per_thread, hash_segment);
+            return result;
+        });
+}
+
+auto FileDiff::compute_strong_hash(const std::string_view input, const StrongHash strong_hash) -> Digest
+{
+    switch (strong_hash)
+    {
+    case StrongHash::std_hash:
+        return { std::hash<std::string_view>{}(input), 0 };
+    case StrongHash::xxh3_128:
+    {
+        const auto hash = XXH3_128bits(std::data(input), std::size(input));
+        return { hash.low64, hash.high64 };
+    }
+    }
+    throw std::runtime_error("Unknown strong hash.");
 }
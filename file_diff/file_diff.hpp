@@ -7,43 +7,206 @@
 
 #include <cassert>
 #include <cmath>
+#include <functional>
 #include <iostream>
+#include <istream>
 #include <ranges>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "../rolling_hash/buzhash.hpp"
+#include "../rolling_hash/crc32c_hash.hpp"
+#include "../rolling_hash/double_polynomial_hash.hpp"
+#include "../rolling_hash/fixed_window_polynomial_hash.hpp"
+#include "../rolling_hash/polynomial_hash.hpp"
+#include "../rolling_hash/rabin_fingerprint.hpp"
+#include "../rolling_hash/rolling_checksum.hpp"
+
 class FileDiff
 {
 public:
     using Hash = uint64_t;
+
+    // How many bytes of the input the streaming `compute_signature` reads at once.
+    static constexpr std::size_t signature_buffer_size{ std::size_t{ 1 } << 23 };
+
+    // Bounds of `get_automatic_chunk_size`.
+    static constexpr std::size_t minimum_automatic_chunk_size{ 512 };
+    static constexpr std::size_t maximum_automatic_chunk_size{ std::size_t{ 1 } << 17 };
+
+    // Rolling ("weak") hash used to find candidate chunks.
+    enum class WeakHash
+    {
+        // Polynomial hash modulo 2^61 - 1, see `PolynomialHash`
+        polynomial,
+        // rsync's two-sum checksum, see `RollingChecksum`. Cheaper to slide, but more collisions.
+        rsync,
+        // Cyclic polynomial hash, see `Buzhash`. A table lookup, rotations and XORs per byte.
+        buzhash,
+        // Rabin fingerprint over GF(2), see `RabinFingerprint`. Table-driven, with provable collision bounds.
+        rabin,
+        // Two polynomial hashes modulo different primes below 2^32, see `DoublePolynomialHash`.
+        double_polynomial,
+        // CRC-32C, see `Crc32cHash`. Whole chunks hashed with the SSE4.2 `crc32` instruction when available.
+        crc32c,
+    };
+
+    // Hash confirming that two chunks with the same weak hash are equal.
+    enum class StrongHash
+    {
+        // `std::hash<std::string_view>`: 64 bits, and implementation-defined, so only the same build can match the
+        // signatures it makes. Signature files that do not record their strong hash were computed with it.
+        std_hash,
+        // XXH3 with 128 bits (see third_party/xxhash), the same with any compiler, and faster on long chunks.
+        xxh3_128,
+    };
+
+    // Value of a strong hash. 64-bit strong hashes leave `high` to 0.
+    struct Digest
+    {
+        uint64_t low{};
+        uint64_t high{};
+
+        auto operator<=>(const Digest&) const = default;
+    };
+
+    // Where chunk boundaries are.
+    enum class Chunking
+    {
+        // Every `chunk_size` bytes. The delta slides over every offset of the new string to find them.
+        fixed,
+        // Where the content says, with FastCDC (see `fastcdc`), `chunk_size` bytes apart on average. Both strings
+        // are cut the same way and chunks are matched whole, so that the chunks after an edit stay the same, and
+        // chunks can be shared between files. No window slides, so there is no weak hash: chunks are matched by
+        // strong hash and length.
+        cdc,
+        // As `cdc`, but at the end of the line of each content-defined cut point (see `line_chunking`), so that
+        // chunks hold whole lines of text. Matched as `cdc`.
+        lines,
+    };
+
     struct Signature
     {
+        // Which weak hash computed `rolling_hashes`. The delta needs to use the same one.
+        WeakHash weak_hash{ WeakHash::polynomial };
+        // Which strong hash computed `strong_hashes`. The delta needs to use the same one.
+        StrongHash strong_hash{ StrongHash::xxh3_128 };
+        // How the chunks were cut.
+        Chunking chunking{ Chunking::fixed };
+        // Chunk size the signature was computed with, or 0 if unknown (older signature files do not record it).
+        std::size_t chunk_size{};
+
         // We will be accessing rolling hashes most of the time, so having them together here
         // is better (cache locality)
 
-        // A rolling hash and a strong hash for each "chunk" in our file.
+        // A rolling hash and a strong hash for each "chunk" in our file (only the strong hash with variable-length
+        // chunks, i.e. not `Chunking::fixed`).
         // SoA vs AoS: https://en.wikipedia.org/wiki/AoS_and_SoA
         // (data-oriented design)
         std::vector<Hash> rolling_hashes{};
-        std::vector<Hash> strong_hashes{};
+        std::vector<Digest> strong_hashes{};
+        // Length of each chunk, only with variable-length chunks. Fixed chunks all have the chunk size, but the last.
+        std::vector<std::size_t> chunk_lengths{};
+        // Length of the last chunk, with fixed chunks, if it is shorter than the chunk size (0 otherwise, or if
+        // unknown). The delta can then match it at the end of the new string, where no whole chunk fits.
+        std::size_t tail_length{};
 
         bool operator==(const Signature& rhs) const
         {
-            return rolling_hashes == rhs.rolling_hashes && strong_hashes == rhs.strong_hashes;
+            return weak_hash == rhs.weak_hash && strong_hash == rhs.strong_hash && chunking == rhs.chunking &&
+                   chunk_size == rhs.chunk_size &&
+                   rolling_hashes == rhs.rolling_hashes && strong_hashes == rhs.strong_hashes &&
+                   chunk_lengths == rhs.chunk_lengths && tail_length == rhs.tail_length;
         }
     };
     using Delta = std::string;
 
+    // What `compute_delta` went through, to judge how well the weak hash filters candidate chunks.
+    struct DeltaStatistics
+    {
+        // Bytes of the new string.
+        std::size_t bytes{};
+        // Windows whose weak hash was in the signature, so that their strong hash had to be computed. Also counts the
+        // end of the new string, when it has the length of the short last chunk of the signature.
+        std::size_t strong_hash_verifications{};
+        // Verifications where the strong hash did not match, i.e. weak hash collisions.
+        std::size_t false_weak_matches{};
+
+        /**
+         * Strong hash verifications per megabyte (10^6 bytes) of the new string.
+         */
+        auto verifications_per_megabyte() const -> double
+        {
+            return bytes == 0 ? 0.0 : static_cast<double>(strong_hash_verifications) * 1e6 / static_cast<double>(bytes);
+        }
+    };
+
+    // Rolling hash, with its parameters and tables, for a given weak hash and chunk size. See below.
+    class HashContext;
+
+    /**
+     * Chunk size for an input of `input_size` bytes, when none is given: about the square root of the size, as rsync
+     * does, so that both the number of chunks and their size grow slowly with the input.
+     * \n
+     * It is rounded down to a power of two, so that the most common sizes hit the polynomial hash specialized for
+     * their window size (see `HashContext`), and clamped between `minimum_automatic_chunk_size` (small inputs would
+     * otherwise have a signature bigger than themselves) and `maximum_automatic_chunk_size`.
+     * It only depends on the size, so the basis file gives the same chunk size as when its signature was computed.
+     * @param input_size Size of the input, in bytes.
+     * @return Chunk size to use.
+     */
+    static auto get_automatic_chunk_size(std::size_t input_size) -> std::size_t;
+
     /**
      * Computes the "signature" for `input_string` and `chunk_size`.
      * \n
      * Signature consists of two hashes for each chunk and is used when matching chunks between files.
      * Chunk size will directly
      * @param input_string String to compute "signature" from.
-     * @param chunk_size Chunk size to use when splitting the file as part of signature process.
+     * @param chunk_size Chunk size to use when splitting the file as part of signature process. It is recorded in the
+     *                   signature.
+     * @param weak_hash Rolling hash to use for the chunks. It is recorded in the signature.
+     * @param chunking How to cut the chunks. It is recorded in the signature.
+     * @param threads Number of threads hashing the chunks. The signature does not depend on it.
+     * @return Signature of `input_string`.
+     */
+    static auto compute_signature(const std::string& input_string, std::size_t chunk_size,
+                                  WeakHash weak_hash = WeakHash::polynomial, Chunking chunking = Chunking::fixed,
+                                  std::size_t threads = 1) -> Signature;
+
+    /**
+     * Same as above, reusing `context` instead of building the rolling hash again.
+     * \n
+     * With several `threads`, each one hashes a contiguous segment of the chunks.
+     * @param input_string String to compute "signature" from.
+     * @param context Weak hash and chunk size to use.
+     * @param chunking How to cut the chunks. It is recorded in the signature.
+     * @param threads Number of threads hashing the chunks. The signature does not depend on it.
      * @return Signature of `input_string`.
      */
-    static auto compute_signature(const std::string& input_string, std::size_t chunk_size) -> Signature;
+    static auto compute_signature(const std::string& input_string, const HashContext& context,
+                                  Chunking chunking = Chunking::fixed, std::size_t threads = 1) -> Signature;
+
+    /**
+     * Same as above, reading the input from a stream, `signature_buffer_size` bytes (rounded to whole chunks) at a
+     * time, so that memory use does not depend on the size of the input.
+     * \n
+     * The chunks of each buffer are passed to `on_chunks` as soon as they are hashed, in order. Together, they are
+     * the chunks of the signature of the whole input.
+     * @param input Stream to read the input from, up to its end.
+     * @param context Weak hash and chunk size to use.
+     * @param chunking How to cut the chunks. It is recorded in the signature.
+     * @param on_chunks Called with the signature of the chunks of each buffer, with the same weak hash, chunking and
+     *                  chunk size as the returned one.
+     * @param threads Number of threads hashing the chunks of each buffer. The signature does not depend on it.
+     * @return Every field of the signature of the whole input, but the chunks, which went to `on_chunks`.
+     */
+    static auto compute_signature(std::istream& input, const HashContext& context, Chunking chunking,
+                                  const std::function<void(const Signature&)>& on_chunks, std::size_t threads = 1)
+        -> Signature;
 
     /**
      * Computes the delta from `my_string` regarding `signature`.
@@ -53,14 +216,29 @@ public:
      * This "delta" can then be used to update the original file (the one from whom the`signature` was
      * computed) to become `my_string`.
      * Note we need to have the same `chunk_size` here as `compute_signature`, for matching the appropriate
-     * portions of `my_string`.
+     * portions of `my_string`. The weak hash and the chunking are the ones recorded in `signature`.
      * @param my_string String to compute differences from `signature`.
      * @param signature Signature of the basis file, previously computed by `compute_signature`.
      * @param chunk_size Chunk size used when previously computing `signature`.
+     * @param threads Number of threads hashing `my_string`. The delta does not depend on it.
+     * @return
+     */
+    static auto compute_delta(const std::string& my_string, const Signature& signature, std::size_t chunk_size,
+                              std::size_t threads = 1) -> Delta;
+
+    /**
+     * Same as above, reusing `context` instead of building the rolling hash again.
+     * Throws if `context` does not use the weak and strong hashes, or the chunk size if any, recorded in
+     * `signature`.
+     * @param my_string String to compute differences from `signature`.
+     * @param signature Signature of the basis file, previously computed by `compute_signature`.
+     * @param context Weak hash and chunk size used when previously computing `signature`.
+     * @param threads Number of threads hashing `my_string`. The delta does not depend on it.
+     * @param statistics If not null, filled with what the computation went through.
      * @return
      */
-    static auto compute_delta(const std::string& my_string, const Signature& signature, std::size_t chunk_size)
-        -> Delta;
+    static auto compute_delta(const std::string& my_string, const Signature& signature, const HashContext& context,
+                              std::size_t threads = 1, DeltaStatistics* statistics = nullptr) -> Delta;
 
     /**
      * Updates `basis_string` using `delta`.
@@ -72,11 +250,25 @@ public:
      * @param basis_string File to be updated.
      * @param delta Delta to use when updating.
      * @param chunk_size Chunk size used when previous computing `signature` and `compute_delta`.
+     * @param chunking Chunking used when previously computing `signature`.
      * @return
      */
-    static auto apply_delta(const std::string& basis_string, const Delta& delta, std::size_t chunk_size) -> std::string;
+    static auto apply_delta(const std::string& basis_string, const Delta& delta, std::size_t chunk_size,
+                            Chunking chunking = Chunking::fixed) -> std::string;
+
+    /**
+     * Views of the chunks of `input`, cut as `chunking` does, without copying them.
+     * \n
+     * With `Chunking::fixed`, chunks are `chunk_size` long but the last, and an empty input has one empty chunk.
+     * @param input String to cut. The views point into it.
+     * @param chunk_size Chunk size, or the size the chunks aim for with variable-length chunks.
+     * @param chunking How to cut the chunks.
+     * @return Chunks, in order.
+     */
+    static auto get_chunk_views(std::string_view input, std::size_t chunk_size, Chunking chunking = Chunking::fixed)
+        -> std::vector<std::string_view>;
 
-    // Public in order to be tested by Catch2
+    // Public in order to be tested by Catch2. They copy every chunk: the library itself uses `get_chunk_views`.
     /**
      * Splits a given string into "chunks" of `chunk_size` size. The last chunk may have a smaller size.
      * @param input_string String to be split into "chunks".
@@ -85,43 +277,197 @@ public:
      */
     static auto split_into_chunks(const std::string& input_string, std::size_t chunk_size) -> std::vector<std::string>;
 
+    /**
+     * Splits a given string into variable-length "chunks", as `chunking` does.
+     * @param input_string String to be split into "chunks".
+     * @param chunk_size Size the chunks aim for.
+     * @param chunking Either `Chunking::cdc` or `Chunking::lines`.
+     * @return Chunks, in order.
+     */
+    static auto split_into_variable_length_chunks(const std::string& input_string, std::size_t chunk_size,
+                                                  Chunking chunking) -> std::vector<std::string>;
+
+    /**
+     * Name of `weak_hash`, as used in the command line and in signature files.
+     * @param weak_hash Weak hash to get the name of.
+     * @return Name of the weak hash.
+     */
+    static auto weak_hash_to_string(WeakHash weak_hash) -> std::string;
+
+    /**
+     * Weak hash called `name`, as in `weak_hash_to_string`.
+     * Throws if there is no weak hash with this name.
+     * @param name Name of the weak hash.
+     * @return Weak hash called `name`.
+     */
+    static auto weak_hash_from_string(const std::string& name) -> WeakHash;
+
+    /**
+     * Name of `strong_hash`, as used in the command line and in signature files.
+     */
+    static auto strong_hash_to_string(StrongHash strong_hash) -> std::string;
+
+    /**
+     * Strong hash called `name`, as in `strong_hash_to_string`.
+     * Throws if there is no strong hash with this name.
+     */
+    static auto strong_hash_from_string(const std::string& name) -> StrongHash;
+
+    /**
+     * Name of `chunking`, as used in the command line and in signature files.
+     */
+    static auto chunking_to_string(Chunking chunking) -> std::string;
+
+    /**
+     * Chunking called `name`, as in `chunking_to_string`.
+     * Throws if there is no chunking with this name.
+     */
+    static auto chunking_from_string(const std::string& name) -> Chunking;
+
 private:
     /**
-     * Computes the rolling hash for a single input.
+     * `compute_delta` for a signature with variable-length chunks: `my_string` is cut the same way, and each chunk
+     * is either a reference to a chunk of the signature with the same strong hash and length, or literal bytes.
+     * Every chunk is hashed with the strong hash, so they all count as verifications in `statistics`.
+     */
+    static auto compute_variable_length_delta(const std::string& my_string, const Signature& signature,
+                                              const HashContext& context, DeltaStatistics* statistics) -> Delta;
+
+    /**
+     * Length of the first chunk of `input`, cut as `chunking` does.
+     * REQUIREMENTS: `chunking` is not `Chunking::fixed`.
+     * @param input Input to cut, starting at a chunk boundary.
+     * @param chunk_size Size the chunks aim for.
+     * @param chunking How to cut the chunk.
+     * @return Size of the first chunk.
+     */
+    static auto find_chunk_end(std::string_view input, std::size_t chunk_size, Chunking chunking) -> std::size_t;
+
+    /**
+     * Largest chunk `chunking` cuts, when it aims for `chunk_size`.
+     * REQUIREMENTS: `chunking` is not `Chunking::fixed`.
+     */
+    static auto get_maximum_chunk_size(std::size_t chunk_size, Chunking chunking) -> std::size_t;
+
+    /**
+     * Length of each chunk of `input`, cut as `chunking` does.
+     * REQUIREMENTS: `chunking` is not `Chunking::fixed`.
+     */
+    static auto get_chunk_lengths(std::string_view input, std::size_t chunk_size, Chunking chunking)
+        -> std::vector<std::size_t>;
+
+    /**
+     * Hashes each one of `chunks`: strong hashes, and rolling hashes or lengths as `chunking` needs.
      * \n
-     * Note that the input does not need to have the window length here.
-     * @param input String to calculate rolling hash from.
-     * @return Rolling hash value.
+     * With several `threads`, each one hashes a contiguous segment of the chunks.
+     * @param chunks Chunks to hash, in order.
+     * @param context Rolling hash to use.
+     * @param chunking How the chunks were cut.
+     * @param threads Maximum number of threads to use.
+     * @return Signature with only the hashes and lengths of `chunks`.
      */
-    static auto compute_single_rolling_hash(const std::string& input) -> Hash;
+    static auto hash_chunks(const std::vector<std::string_view>& chunks, const HashContext& context,
+                            Chunking chunking, std::size_t threads) -> Signature;
 
     /**
-     * Computes rolling hashes for all "sliding windows" of `chunk_size` in `input`.
+     * Computes rolling hashes for all "sliding windows" of the context's chunk size in `input`.
+     * \n
+     * With several `threads`, each one hashes a contiguous segment of the windows.
      * @param input String to calculate rolling hashes from.
-     * @param chunk_size Size of each "window".
+     * @param context Rolling hash to use, and size of each "window".
+     * @param threads Maximum number of threads to use.
      * @return A rolling hash value for each window, in order.
      */
-    static auto compute_rolling_hashes(const std::string& input, std::size_t chunk_size) -> std::vector<Hash>;
+    static auto compute_rolling_hashes(const std::string& input, const HashContext& context, std::size_t threads)
+        -> std::vector<Hash>;
 
     /**
-     * Computes a "strong" hash for a single input.
-     * \n
-     * Specifically, it computes C++'s implementation-defined hash for std::string.
-     * We would change this to a particularly chosen hash function in a production application.
+     * Computes a "strong" hash for a single input, directly over its bytes.
      * @param input String to calculate hash from.
+     * @param strong_hash Which hash to compute.
      * @return Hash value.
      */
-    static auto compute_strong_hash(const std::string& input) -> Hash;
+    static auto compute_strong_hash(std::string_view input, StrongHash strong_hash) -> Digest;
 
 private:
     // Ascii size plus one
     static const uint64_t m_rolling_hash_base{ 257 };
-    // A big prime number
-    static const uint64_t m_rolling_hash_modulo{ static_cast<uint64_t>(1e9 + 7) };
+    // The Mersenne prime 2^61 - 1 (`PolynomialHash::mersenne_modulo`).
+    // Reducing by it needs no division, and the hash space is much bigger than with a prime around 2^30, which
+    // means far fewer weak hash matches that the strong hash then has to refute.
+    static const uint64_t m_rolling_hash_modulo{ (uint64_t{ 1 } << 61) - 1 };
     // This token indicates that the next byte is a literal byte
     static const char human_readable_byte_token{ 'b' };
     // This token indicates that the next number (may be multiple bytes) is the chunk id that matches
     static const char human_readable_reference_token{ '@' };
 };
 
+/**
+ * Everything needed to compute the weak hashes of chunks of `chunk_size`: the `RollingHash` policy, with its
+ * parameters and precomputed tables.
+ * \n
+ * Building the policy is the only costly part of hashing a chunk, so it is done once here. The context is then
+ * only read, so it can be shared by every chunk, every call, and every thread.
+ */
+class FileDiff::HashContext
+{
+public:
+    /**
+     * Builds the rolling hash for `weak_hash` and windows of `chunk_size`.
+     * @param weak_hash Weak hash to use.
+     * @param chunk_size Size of the chunks to hash.
+     * @param strong_hash Strong hash to use along with it. It has no state to build.
+     */
+    HashContext(WeakHash weak_hash, std::size_t chunk_size, StrongHash strong_hash = StrongHash::xxh3_128);
+
+    auto get_weak_hash() const -> WeakHash
+    {
+        return m_weak_hash;
+    }
+
+    auto get_strong_hash() const -> StrongHash
+    {
+        return m_strong_hash;
+    }
+
+    auto get_chunk_size() const -> std::size_t
+    {
+        return m_chunk_size;
+    }
+
+    /**
+     * Calls `function` with the policy.
+     * \n
+     * This is the single point where the weak hash chosen at runtime becomes a compile-time policy, so that the
+     * per-byte loops inside `function` have no virtual call nor branch on the kind of hash.
+     * @param function Generic callable, taking any policy by const reference.
+     * @return What `function` returns.
+     */
+    template <typename Function>
+    auto visit(Function&& function) const -> decltype(auto)
+    {
+        return std::visit(std::forward<Function>(function), m_policy);
+    }
+
+private:
+    // The chunk sizes we deploy have their window size, and all the powers of the base, known at compile time.
+    template <std::size_t WindowSize>
+    using FixedWindowHash = FixedWindowPolynomialHash<FileDiff::m_rolling_hash_base, WindowSize>;
+
+    using Policy = std::variant<PolynomialHash, FixedWindowHash<512>, FixedWindowHash<1024>, FixedWindowHash<2048>,
+                                FixedWindowHash<4096>, FixedWindowHash<8192>, RollingChecksum, Buzhash,
+                                RabinFingerprint, DoublePolynomialHash, Crc32cHash>;
+
+    /**
+     * Builds the policy for `weak_hash` and windows of `chunk_size`.
+     */
+    static auto make_policy(WeakHash weak_hash, std::size_t chunk_size) -> Policy;
+
+private:
+    WeakHash m_weak_hash;
+    StrongHash m_strong_hash;
+    std::size_t m_chunk_size;
+    Policy m_policy;
+};
+
 #endif // ROLLING_HASH_FILE_DIFF_FILE_DIFF_HPP
@@ -4,16 +4,105 @@
 
 #include "io_helpers.hpp"
 
+#include <cctype>
+#include <stdexcept>
+#include <string_view>
+
 namespace io_helpers
 {
+    namespace
+    {
+        /**
+         * Whether `strong_hash` has 128 bits, written as two numbers.
+         */
+        auto is_wide(const FileDiff::StrongHash strong_hash) -> bool
+        {
+            return strong_hash != FileDiff::StrongHash::std_hash;
+        }
+
+        /**
+         * Line of a strong hash: its high then low 64 bits, or only the low ones for a 64-bit strong hash.
+         */
+        auto digest_to_string(const FileDiff::Digest& digest, const FileDiff::StrongHash strong_hash) -> std::string
+        {
+            if (!is_wide(strong_hash))
+                return std::to_string(digest.low);
+            return std::to_string(digest.high) + ' ' + std::to_string(digest.low);
+        }
+
+        /**
+         * "key value" lines of the fields of `signature` known before its chunks.
+         */
+        auto get_signature_header(const FileDiff::Signature& signature) -> std::string
+        {
+            auto result = std::string{};
+            result += std::string{ weak_hash_key } + ' ' + FileDiff::weak_hash_to_string(signature.weak_hash) + '\n';
+            result +=
+                std::string{ strong_hash_key } + ' ' + FileDiff::strong_hash_to_string(signature.strong_hash) + '\n';
+            result += std::string{ chunking_key } + ' ' + FileDiff::chunking_to_string(signature.chunking) + '\n';
+            if (signature.chunk_size != 0)
+                result += std::string{ chunk_size_key } + ' ' + std::to_string(signature.chunk_size) + '\n';
+            return result;
+        }
+
+        /**
+         * Appends the two lines of each chunk of `signature` to `output`.
+         */
+        auto append_signature_chunks(std::string& output, const FileDiff::Signature& signature) -> void
+        {
+            // Variable-length chunks have their length instead of a rolling hash
+            const auto has_lengths = signature.chunking != FileDiff::Chunking::fixed;
+            const auto size = std::size(signature.strong_hashes);
+            assert(std::size(has_lengths ? signature.chunk_lengths : signature.rolling_hashes) == size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const auto strong_hash = digest_to_string(signature.strong_hashes.at(i), signature.strong_hash);
+                if (has_lengths)
+                {
+                    output += strong_hash + '\n';
+                    output += std::to_string(signature.chunk_lengths.at(i)) + '\n';
+                }
+                else
+                {
+                    output += std::to_string(signature.rolling_hashes.at(i)) + '\n';
+                    output += strong_hash + '\n';
+                }
+            }
+        }
+
+        /**
+         * "key value" lines of the fields of `signature` only known after all its chunks.
+         */
+        auto get_signature_trailer(const FileDiff::Signature& signature) -> std::string
+        {
+            if (signature.tail_length == 0)
+                return {};
+            return std::string{ tail_length_key } + ' ' + std::to_string(signature.tail_length) + '\n';
+        }
+    } // namespace
+
     auto read_file_to_string(const std::string& file_path) -> std::string
     {
-        auto input_file = std::ifstream{ file_path };
+        auto input_file = std::ifstream{ file_path, std::ios::binary };
         if (!input_file)
             throw std::runtime_error("Could not open file\n");
-        auto stream = std::stringstream{};
-        stream << input_file.rdbuf();
-        return stream.str();
+        // Read straight into a string of the file's size: going through a `std::stringstream` would hold the
+        // contents twice
+        input_file.seekg(0, std::ios::end);
+        const auto size = static_cast<std::streamoff>(input_file.tellg());
+        if (size < 0)
+        {
+            // Not seekable (e.g. a pipe)
+            input_file.clear();
+            auto stream = std::stringstream{};
+            stream << input_file.rdbuf();
+            return stream.str();
+        }
+        auto result = std::string(static_cast<std::size_t>(size), '\0');
+        input_file.seekg(0);
+        if (!input_file.read(std::data(result), size))
+            throw std::runtime_error("Could not read file\n");
+        return result;
     }
 
     auto save_to_file(const std::string& file_path, const std::string& content) -> void
@@ -25,39 +114,151 @@ namespace io_helpers
         output_file << content;
     }
 
-    auto save_signature_to_file(const std::string& file_path, const FileDiff::Signature& signature) -> void
+    auto read_delta_from_file(const std::string& file_path) -> DeltaFile
     {
-        auto as_string = std::string{};
-        assert(std::size(signature.rolling_hashes) == std::size(signature.strong_hashes));
-        const auto size = std::size(signature.rolling_hashes);
-        for (std::size_t i = 0; i < size; ++i)
+        auto content = read_file_to_string(file_path);
+        auto result = DeltaFile{};
+        // Header lines, up to the first token of the delta
+        auto start = std::size_t{};
+        while (start < std::size(content) && content[start] != '@' && content[start] != 'b')
         {
-            const auto rolling_hash = signature.rolling_hashes.at(i);
-            const auto strong_hash = signature.strong_hashes.at(i);
-            // TODO: Document this file structure.
-            as_string += std::to_string(rolling_hash) + '\n';
-            as_string += std::to_string(strong_hash) + '\n';
+            const auto line_end = content.find('\n', start);
+            if (line_end == std::string::npos)
+                throw std::runtime_error("Unfinished delta header line.");
+            const auto line = std::string_view{ content }.substr(start, line_end - start);
+            const auto separator = line.find(' ');
+            const auto key = line.substr(0, separator);
+            const auto value = std::string{ separator == std::string_view::npos ? "" : line.substr(separator + 1) };
+            if (key == chunking_key)
+                result.chunking = FileDiff::chunking_from_string(value);
+            else if (key == chunk_size_key)
+                result.chunk_size = std::stoull(value);
+            else
+                throw std::runtime_error("Unknown delta field: " + std::string{ key });
+            start = line_end + 1;
         }
+        content.erase(0, start);
+        result.delta = std::move(content);
+        return result;
+    }
+
+    auto save_delta_to_file(const std::string& file_path, const DeltaFile& delta_file) -> void
+    {
+        auto output_file = std::ofstream{ file_path, std::ios::binary };
+        if (!output_file)
+            throw std::runtime_error("Could not save results to file");
+        if (delta_file.chunking)
+            output_file << chunking_key << ' ' << FileDiff::chunking_to_string(*delta_file.chunking) << '\n';
+        if (delta_file.chunk_size != 0)
+            output_file << chunk_size_key << ' ' << delta_file.chunk_size << '\n';
+        output_file << delta_file.delta;
+        if (!output_file)
+            throw std::runtime_error("Could not save results to file");
+    }
+
+    auto save_signature_to_file(const std::string& file_path, const FileDiff::Signature& signature) -> void
+    {
+        auto as_string = get_signature_header(signature);
+        append_signature_chunks(as_string, signature);
+        as_string += get_signature_trailer(signature);
         save_to_file(file_path, as_string);
     }
 
+    auto save_signature_to_file(const std::string& file_path, std::istream& input,
+                                const FileDiff::HashContext& context, const FileDiff::Chunking chunking,
+                                const std::size_t threads) -> void
+    {
+        auto output_file = std::ofstream{ file_path };
+        if (!output_file)
+            throw std::runtime_error("Could not save results to file");
+        // Everything in the header is known before reading the input
+        auto header = FileDiff::Signature{};
+        header.weak_hash = context.get_weak_hash();
+        header.strong_hash = context.get_strong_hash();
+        header.chunking = chunking;
+        header.chunk_size = context.get_chunk_size();
+        output_file << get_signature_header(header);
+
+        auto chunk_lines = std::string{};
+        const auto signature = FileDiff::compute_signature(
+            input, context, chunking,
+            [&output_file, &chunk_lines](const FileDiff::Signature& chunks)
+            {
+                chunk_lines.clear();
+                append_signature_chunks(chunk_lines, chunks);
+                output_file << chunk_lines;
+            },
+            threads);
+        output_file << get_signature_trailer(signature);
+        if (!output_file)
+            throw std::runtime_error("Could not save results to file");
+    }
+
     auto read_signature_from_file(const std::string& file_path) -> FileDiff::Signature
     {
         auto input_file = std::ifstream{ file_path };
         if (!input_file)
             throw std::runtime_error("Could not open file\n");
         auto result = FileDiff::Signature{};
-        auto current_hash = FileDiff::Hash{};
-        // TODO: Document this input operations.
-        bool is_rolling = true;
-        while (input_file >> current_hash)
+        // Unless the file says otherwise, as older ones do not record it
+        result.strong_hash = FileDiff::StrongHash::std_hash;
+        auto has_weak_hash = false;
+
+        // "key value" lines, in the header or the trailer
+        const auto read_fields = [&input_file, &result, &has_weak_hash]
+        {
+            // The hashes are all numbers, so a field starts with anything else
+            while (input_file >> std::ws && !std::isdigit(input_file.peek()) && input_file.peek() != EOF)
+            {
+                auto key = std::string{};
+                auto value = std::string{};
+                input_file >> key >> value;
+                if (key == weak_hash_key)
+                {
+                    result.weak_hash = FileDiff::weak_hash_from_string(value);
+                    has_weak_hash = true;
+                }
+                else if (key == strong_hash_key)
+                    result.strong_hash = FileDiff::strong_hash_from_string(value);
+                else if (key == chunking_key)
+                    result.chunking = FileDiff::chunking_from_string(value);
+                else if (key == chunk_size_key)
+                    result.chunk_size = static_cast<std::size_t>(std::stoull(value));
+                else if (key == tail_length_key)
+                    result.tail_length = static_cast<std::size_t>(std::stoull(value));
+                else
+                    throw std::runtime_error("Unknown signature field: " + key);
+            }
+        };
+        read_fields();
+        // Files without a header come from the first versions, whose polynomial hash used another modulo: none of
+        // their chunks would ever match.
+        if (!has_weak_hash)
+            throw std::runtime_error("The signature file has no header, it must be computed again.");
+
+        // Then, for each chunk, its rolling hash followed by its strong hash
+        // (its strong hash followed by its length, for variable-length chunks)
+        const auto has_lengths = result.chunking != FileDiff::Chunking::fixed;
+        const auto wide = is_wide(result.strong_hash);
+        const auto read_digest = [&input_file, wide](FileDiff::Digest& digest) -> bool
+        {
+            if (wide)
+                input_file >> digest.high;
+            return static_cast<bool>(input_file >> digest.low);
+        };
+        auto hash = FileDiff::Hash{};
+        auto digest = FileDiff::Digest{};
+        while (has_lengths ? read_digest(digest) && input_file >> hash : input_file >> hash && read_digest(digest))
         {
-            if (is_rolling)
-                result.rolling_hashes.push_back(current_hash);
+            result.strong_hashes.push_back(digest);
+            if (has_lengths)
+                result.chunk_lengths.push_back(static_cast<std::size_t>(hash));
             else
-                result.strong_hashes.push_back(current_hash);
-            is_rolling = !is_rolling;
+                result.rolling_hashes.push_back(hash);
         }
+        // Reading the hashes stopped at the trailer, if any
+        input_file.clear();
+        read_fields();
         return result;
     }
 } // namespace io_helpers
@@ -6,6 +6,7 @@
 #define IO_HELPERS_HPP
 
 #include <fstream>
+#include <optional>
 #include <sstream>
 #include <string>
 
@@ -13,13 +14,68 @@
 
 namespace io_helpers
 {
+    // Signature files are human-readable. They start with a header of "key value" lines:
+    //     weak-hash <name of the weak hash, e.g. polynomial>
+    //     strong-hash <name of the strong hash, e.g. xxh3-128>
+    //     chunking <name of the chunking, e.g. fixed>
+    //     chunk-size <chunk size, in bytes>
+    // followed by two lines per chunk, in order: its rolling hash and its strong hash. With variable-length chunks
+    // (content-defined or line-aware), the two lines are its strong hash and its length instead. 128-bit strong
+    // hashes are written as their high then low 64 bits, on the same line.
+    // They end with "key value" lines only known once every chunk is hashed, which a streamed signature can only
+    // write last:
+    //     tail-length <length of the last chunk, only with fixed chunks, if shorter than the chunk size>
+    // Any field may be in either place when reading. Files without a weak-hash line, from before the header, are
+    // rejected.
+    inline constexpr auto weak_hash_key = "weak-hash";
+    // Missing from older signature files, which used `FileDiff::StrongHash::std_hash`.
+    inline constexpr auto strong_hash_key = "strong-hash";
+    inline constexpr auto chunking_key = "chunking";
+    // Missing from older signature files, which leaves `FileDiff::Signature::chunk_size` unknown (0).
+    inline constexpr auto chunk_size_key = "chunk-size";
+    // Chunk size of the signature and delta files that do not record one, the former default.
+    inline constexpr auto legacy_chunk_size = std::size_t{ 30 };
+    inline constexpr auto tail_length_key = "tail-length";
+
+    // Delta files start with a header of "key value" lines as well, with what `patch` needs to find the chunks the
+    // delta refers to:
+    //     chunking <name of the chunking of the signature, e.g. fixed>
+    //     chunk-size <chunk size of the signature>
+    // followed by the delta itself. The delta starts with a token ('@' or 'b'), which no key starts with. Older delta
+    // files have no header.
+    struct DeltaFile
+    {
+        FileDiff::Delta delta{};
+        // How the basis file was cut into chunks, if recorded.
+        std::optional<FileDiff::Chunking> chunking{};
+        // Chunk size of the signature, 0 if not recorded.
+        std::size_t chunk_size{};
+    };
+
     auto read_file_to_string(const std::string& file_path) -> std::string;
 
     auto read_signature_from_file(const std::string& file_path) -> FileDiff::Signature;
 
     auto save_to_file(const std::string& file_path, const std::string& content) -> void;
 
+    auto read_delta_from_file(const std::string& file_path) -> DeltaFile;
+
+    auto save_delta_to_file(const std::string& file_path, const DeltaFile& delta_file) -> void;
+
     auto save_signature_to_file(const std::string& file_path, const FileDiff::Signature& signature) -> void;
+
+    /**
+     * Computes the signature of `input` and saves it to `file_path` as it goes, with the streaming
+     * `FileDiff::compute_signature`: neither the input nor the signature are ever whole in memory.
+     * @param file_path Path of the signature file.
+     * @param input Stream to read the input from, up to its end.
+     * @param context Weak hash and chunk size to use.
+     * @param chunking How to cut the chunks.
+     * @param threads Number of threads hashing the chunks. The signature does not depend on it.
+     */
+    auto save_signature_to_file(const std::string& file_path, std::istream& input,
+                                const FileDiff::HashContext& context, FileDiff::Chunking chunking,
+                                std::size_t threads = 1) -> void;
 } // namespace io_helpers
 
 #endif // IO_HELPERS_HPP
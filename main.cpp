@@ -1,6 +1,10 @@
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
 
 #include "file_diff/file_diff.hpp"
+#include "rolling_hash/cpu_dispatch.hpp"
 #include "io_helpers/io_helpers.hpp"
 
 auto main(int argc, const char* argv[]) -> int
@@ -31,10 +35,24 @@ auto main(int argc, const char* argv[]) -> int
                     ./rolling_hash_file_diff delta signature-file new-file delta-file [options]\n\
                     ./rolling_hash_file_diff patch basis-file delta-file new-file [options]\n"
                        "You may pass '--chunk-size X' in [options] to explicitly ask for a chunk size to be used.\n"
-                       "Note that if you choose to do so, you need to pass the same chunk-size to all other related"
-                       "commands.\n"
+                       "It is recorded in the signature and delta files, so it only needs passing to signature.\n"
                        "e.g. \n./rolling_hash_file_diff signature my_file out_file --chunk-size 30\n"
-                       "will call the signature command with 30 bytes chunk size.\n"s;
+                       "will call the signature command with 30 bytes chunk size.\n"
+                       "By default, the signature command picks about the square root of the file size, and records\n"
+                       "it in the signature file. The delta command reads it from there, and records it in the delta\n"
+                       "file for the patch command.\n"
+                       "You may also pass '--weak-hash NAME' to the signature command to choose the rolling hash,\n"
+                       "one of 'polynomial' (default), 'rsync', 'buzhash', 'rabin', 'double-polynomial' or 'crc32c'.\n"
+                       "It is recorded in the signature file, so the delta command uses it automatically.\n"
+                       "Likewise, '--strong-hash NAME' chooses the strong hash, 'xxh3-128' (default) or 'std'.\n"
+                       "You may pass '--chunking cdc' to the signature command to cut content-defined chunks\n"
+                       "(FastCDC), chunk-size bytes long on average, instead of 'fixed' ones (default), or\n"
+                       "'--chunking lines' to cut content-defined chunks that end at the end of a line.\n"
+                       "It is recorded in the signature and delta files, so the other commands use it automatically.\n"
+                       "You may pass '--threads N' to the signature and delta commands to hash the file with N\n"
+                       "threads. The signature and the delta do not depend on it.\n"
+                       "You may pass '--stats' to the delta command to print how many chunks had to be checked with\n"
+                       "the strong hash, which is how well the weak hash filters candidates.\n"s;
 
     // TODO: We do not treat user mistakes nor sanitize the input.
     if (argc <= 1)
@@ -43,8 +61,12 @@ auto main(int argc, const char* argv[]) -> int
         exit(0);
     }
 
-    // 1. Check if user specified a chunk size
-    auto chunk_size = std::size_t{ 30 }; // Default chunk size is 30 bytes
+    // Pick the instruction set of the hashing kernels once, before any work, so that a bad ROLLING_HASH_ISA fails
+    // right away
+    cpu_dispatch::get_active_isa_level();
+
+    // 1. Check if user specified a chunk size (otherwise, it depends on the file size)
+    auto chunk_size = std::optional<std::size_t>{};
     for (auto i = 1; i < argc; ++i)
     {
         if (argv[i] == "--chunk-size"s)
@@ -54,29 +76,115 @@ auto main(int argc, const char* argv[]) -> int
         }
     }
 
+    // Check if user specified a weak hash (only meaningful for the signature command)
+    auto weak_hash = FileDiff::WeakHash::polynomial;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (argv[i] == "--weak-hash"s)
+        {
+            assert(i + 1 < argc);
+            weak_hash = FileDiff::weak_hash_from_string(argv[i + 1]);
+        }
+    }
+
+    // Check if user specified a strong hash (only meaningful for the signature command)
+    auto strong_hash = FileDiff::StrongHash::xxh3_128;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (argv[i] == "--strong-hash"s)
+        {
+            assert(i + 1 < argc);
+            strong_hash = FileDiff::strong_hash_from_string(argv[i + 1]);
+        }
+    }
+
+    // Check if user specified a chunking (only meaningful for the signature command, the delta records it)
+    auto chunking = std::optional<FileDiff::Chunking>{};
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (argv[i] == "--chunking"s)
+        {
+            assert(i + 1 < argc);
+            chunking = FileDiff::chunking_from_string(argv[i + 1]);
+        }
+    }
+
+    // Check if user specified a number of threads (meaningful for the signature and delta commands)
+    auto threads = std::size_t{ 1 };
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (argv[i] == "--threads"s)
+        {
+            assert(i + 1 < argc);
+            threads = static_cast<std::size_t>(std::stoi(argv[i + 1]));
+        }
+    }
+
+    // Check if user asked for the delta statistics
+    auto print_statistics = false;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (argv[i] == "--stats"s)
+            print_statistics = true;
+    }
+
     // 2. Parse the user command
     const auto command = std::string(argv[1]);
     if (command == "signature")
     {
-        const auto old_file = io_helpers::read_file_to_string(argv[2]);
+        // The old file is streamed, so that it never has to fit in memory
+        auto old_file = std::ifstream{ argv[2], std::ios::binary };
+        if (!old_file)
+            throw std::runtime_error("Could not open file\n");
         const auto signature_file = argv[3];
-        const auto signature = FileDiff::compute_signature(old_file, chunk_size);
-        io_helpers::save_signature_to_file(signature_file, signature);
+        // Only regular files have a size before they are read. Other inputs get the smallest automatic chunk size,
+        // which is recorded in the signature and delta files like any other.
+        const auto old_file_size = std::filesystem::is_regular_file(argv[2]) ? std::filesystem::file_size(argv[2]) : 0;
+        const auto automatic_chunk_size = FileDiff::get_automatic_chunk_size(static_cast<std::size_t>(old_file_size));
+        const auto context =
+            FileDiff::HashContext(weak_hash, chunk_size.value_or(automatic_chunk_size), strong_hash);
+        io_helpers::save_signature_to_file(signature_file, old_file, context,
+                                           chunking.value_or(FileDiff::Chunking::fixed), threads);
     }
     else if (command == "delta")
     {
         const auto signature = io_helpers::read_signature_from_file(argv[2]);
         const auto new_file = io_helpers::read_file_to_string(argv[3]);
         const auto delta_file = argv[4];
-        const auto delta = FileDiff::compute_delta(new_file, signature, chunk_size);
-        io_helpers::save_to_file(delta_file, delta);
+        // Signature files that do not record their chunk size were computed with the former default
+        const auto recorded_chunk_size =
+            signature.chunk_size != 0 ? signature.chunk_size : io_helpers::legacy_chunk_size;
+        const auto context = FileDiff::HashContext(signature.weak_hash, chunk_size.value_or(recorded_chunk_size),
+                                                   signature.strong_hash);
+        auto statistics = FileDiff::DeltaStatistics{};
+        const auto delta = FileDiff::compute_delta(new_file, signature, context, threads, &statistics);
+        io_helpers::save_delta_to_file(delta_file, { delta, signature.chunking, context.get_chunk_size() });
+        if (print_statistics)
+        {
+            std::cout << "Strong hash verifications: " << statistics.strong_hash_verifications << " ("
+                      << statistics.verifications_per_megabyte() << " per MB), of which "
+                      << statistics.false_weak_matches << " were weak hash collisions.\n";
+        }
     }
     else if (command == "patch")
     {
         const auto basis_file = io_helpers::read_file_to_string(argv[2]);
-        const auto delta_file = io_helpers::read_file_to_string(argv[3]);
+        const auto delta_file = io_helpers::read_delta_from_file(argv[3]);
         const auto reconstructed_file = argv[4];
-        const auto reconstructed = FileDiff::apply_delta(basis_file, delta_file, chunk_size);
+        // The delta records the chunking and chunk size of its signature. Older deltas do not, and need '--chunking'
+        // and '--chunk-size' again.
+        if (chunking && delta_file.chunking && chunking != delta_file.chunking)
+            throw std::runtime_error("The delta was computed with the chunking '" +
+                                     FileDiff::chunking_to_string(*delta_file.chunking) + "', not '" +
+                                     FileDiff::chunking_to_string(*chunking) + "'.");
+        if (chunk_size && delta_file.chunk_size != 0 && chunk_size != delta_file.chunk_size)
+            throw std::runtime_error("The delta was computed with chunks of " + std::to_string(delta_file.chunk_size) +
+                                     " bytes, not " + std::to_string(*chunk_size) + ".");
+        const auto recorded_chunk_size =
+            delta_file.chunk_size != 0 ? delta_file.chunk_size : io_helpers::legacy_chunk_size;
+        const auto reconstructed =
+            FileDiff::apply_delta(basis_file, delta_file.delta, chunk_size.value_or(recorded_chunk_size),
+                                  delta_file.chunking.value_or(chunking.value_or(FileDiff::Chunking::fixed)));
         io_helpers::save_to_file(reconstructed_file, reconstructed);
     }
     else
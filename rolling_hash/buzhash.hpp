@@ -0,0 +1,103 @@
+//
+// Buzhash (hashing by cyclic polynomial), from Robert Uzgalis' "Hashing concepts and the Java programming language".
+// References:
+// Wikipedia: https://en.wikipedia.org/wiki/Rolling_hash#Cyclic_polynomial
+// Daniel Lemire and Owen Kaser, "Recursive n-gram hashing is pairwise independent, at best":
+//          https://arxiv.org/abs/0705.4676
+//
+
+#ifndef BUZHASH_HPP
+#define BUZHASH_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+/**
+ * `RollingHash` policy: every byte is mapped to a random 64-bit value by a 256-entry table, and the hash of a
+ * window is the XOR of those values, each rotated by its distance to the end of the window.
+ * \n
+ * Sliding takes one rotation of the hash, one rotation of the outgoing value and two XORs: no multiplication,
+ * modulo nor power table. As it only depends on the bytes inside the window, it is also well suited for choosing
+ * content-defined chunk boundaries.
+ */
+class Buzhash
+{
+public:
+    using Hash = uint64_t;
+
+    // Lanes for `hash_windows`. Each slide is only a few cheap operations, so more lanes just add register pressure.
+    static constexpr std::size_t interleaved_lanes{ 2 };
+
+    /**
+     * Random value for each byte. They are generated at compile time with a fixed seed (through splitmix64), so
+     * that every build computes the same hashes, and signatures can be shared between them.
+     */
+    static constexpr auto byte_values = []
+    {
+        auto result = std::array<uint64_t, 256>{};
+        auto state = uint64_t{ 0x9E3779B97F4A7C15 };
+        for (auto& value : result)
+        {
+            state += 0x9E3779B97F4A7C15;
+            auto mixed = state;
+            mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EB;
+            value = mixed ^ (mixed >> 31);
+        }
+        return result;
+    }();
+
+public:
+    /**
+     * @param window_size Size of the window the hash slides with.
+     */
+    explicit Buzhash(std::size_t window_size)
+        : m_window_size{ window_size }, m_first_character_rotation{ static_cast<int>(window_size % 64) }
+    {
+    }
+
+    auto get_window_size() const -> std::size_t
+    {
+        return m_window_size;
+    }
+
+    /**
+     * Hash of the window grown by `c` at its end.
+     * @param hash Hash of the window.
+     * @param c Character to append.
+     * @return Updated hash.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        // Every character already in the window gets one step further from the end, so is rotated once more.
+        return std::rotl(hash, 1) ^ get_byte_value(c);
+    }
+
+    /**
+     * Hash of the window without its first character, just after a character was appended to it.
+     * @param hash Hash of the window, of length `window_size + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated hash.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        // XOR is its own inverse, so we just XOR the (rotated) value out.
+        return hash ^ std::rotl(get_byte_value(first_character), m_first_character_rotation);
+    }
+
+private:
+    static auto get_byte_value(char c) -> uint64_t
+    {
+        return byte_values[static_cast<unsigned char>(c)];
+    }
+
+private:
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{};
+    // The value of the first character has been rotated once per character after it: with the character just
+    // appended, `m_window_size` times. Rotations are modulo 64.
+    int m_first_character_rotation{};
+};
+
+#endif // BUZHASH_HPP
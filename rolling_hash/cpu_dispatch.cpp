@@ -0,0 +1,101 @@
+//
+// Picking, at runtime, which instruction set the hashing kernels use.
+//
+
+#include "cpu_dispatch.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_DISPATCH_X86
+#endif
+
+namespace cpu_dispatch
+{
+    namespace
+    {
+        constexpr auto all_levels =
+            std::array{ IsaLevel::baseline, IsaLevel::x86_64_v2, IsaLevel::x86_64_v3, IsaLevel::x86_64_v4 };
+    } // namespace
+
+    auto is_supported(const IsaLevel level) -> bool
+    {
+        switch (level)
+        {
+        case IsaLevel::baseline:
+            return true;
+#ifdef CPU_DISPATCH_X86
+        // __builtin_cpu_supports reads what cpuid reported, once, when the program started
+        case IsaLevel::x86_64_v2:
+            return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        case IsaLevel::x86_64_v3:
+            return is_supported(IsaLevel::x86_64_v2) && __builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma");
+        case IsaLevel::x86_64_v4:
+            return is_supported(IsaLevel::x86_64_v3) && __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+                   __builtin_cpu_supports("avx512vl");
+#else
+        default:
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    auto get_active_isa_level() -> IsaLevel
+    {
+        static const auto active = []
+        {
+            if (const auto* const name = std::getenv(isa_level_variable))
+            {
+                const auto level = isa_level_from_string(name);
+                if (!is_supported(level))
+                    throw std::runtime_error("This CPU does not support the ISA level in " +
+                                             std::string{ isa_level_variable } + ": " + name);
+                return level;
+            }
+            auto best = IsaLevel::baseline;
+            for (const auto level : all_levels)
+            {
+                if (is_supported(level))
+                    best = level;
+            }
+            return best;
+        }();
+        return active;
+    }
+
+    auto is_enabled(const IsaLevel level) -> bool
+    {
+        return level <= get_active_isa_level();
+    }
+
+    auto isa_level_to_string(const IsaLevel level) -> std::string
+    {
+        switch (level)
+        {
+        case IsaLevel::baseline:
+            return "baseline";
+        case IsaLevel::x86_64_v2:
+            return "x86-64-v2";
+        case IsaLevel::x86_64_v3:
+            return "x86-64-v3";
+        case IsaLevel::x86_64_v4:
+            return "x86-64-v4";
+        }
+        throw std::runtime_error("Unknown ISA level.");
+    }
+
+    auto isa_level_from_string(const std::string& name) -> IsaLevel
+    {
+        for (const auto level : all_levels)
+        {
+            if (isa_level_to_string(level) == name)
+                return level;
+        }
+        throw std::runtime_error("Unknown ISA level: " + name);
+    }
+} // namespace cpu_dispatch
@@ -0,0 +1,63 @@
+//
+// Picking, at runtime, which instruction set the hashing kernels use.
+// The binary is built for the baseline ISA. Kernels needing more are compiled with `target` attributes, and only run
+// when the CPU has those instructions.
+// Reference for the levels: https://gitlab.com/x86-psABIs/x86-64-ABI
+//
+
+#ifndef CPU_DISPATCH_HPP
+#define CPU_DISPATCH_HPP
+
+#include <string>
+
+namespace cpu_dispatch
+{
+    // x86-64 microarchitecture levels, from the most portable to the most recent. Each one includes the previous.
+    enum class IsaLevel
+    {
+        // What the binary is compiled for. Runs everywhere.
+        baseline,
+        // SSE4.2 and POPCNT: the SSE4.1 rolling checksum kernel, and the crc32 instruction
+        x86_64_v2,
+        // AVX2, BMI2 and FMA: the AVX2 rolling checksum kernel
+        x86_64_v3,
+        // AVX-512 (F, BW, DQ, VL): the AVX-512 rolling checksum kernel
+        x86_64_v4,
+    };
+
+    // Environment variable forcing a lower level than the CPU supports, e.g. to compare kernels in benchmarks.
+    inline constexpr auto isa_level_variable = "ROLLING_HASH_ISA";
+
+    /**
+     * Whether the CPU we are running on supports every instruction of `level`.
+     * @param level Level to check.
+     * @return True if code compiled for `level` can run.
+     */
+    auto is_supported(IsaLevel level) -> bool;
+
+    /**
+     * Level the kernels are picked for: the highest one the CPU supports, unless `isa_level_variable` names another.
+     * Decided once, on the first call.
+     * \n
+     * Throws if the variable names an unknown level, or one the CPU does not support.
+     * @return Level to use.
+     */
+    auto get_active_isa_level() -> IsaLevel;
+
+    /**
+     * Whether kernels written for `level` may be used, i.e. it is not above the active level.
+     * @param level Level the kernel needs.
+     * @return True if the kernel may run.
+     */
+    auto is_enabled(IsaLevel level) -> bool;
+
+    auto isa_level_to_string(IsaLevel level) -> std::string;
+
+    /**
+     * Level named `name`, as `isa_level_to_string` writes it (e.g. "x86-64-v3").
+     * Throws if there is no such level.
+     */
+    auto isa_level_from_string(const std::string& name) -> IsaLevel;
+} // namespace cpu_dispatch
+
+#endif // CPU_DISPATCH_HPP
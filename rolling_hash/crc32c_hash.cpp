@@ -0,0 +1,82 @@
+//
+// CRC-32C (Castagnoli) as a rolling hash.
+// References:
+// Intel, "Fast CRC Computation for iSCSI Polynomial Using CRC32 Instruction"
+// Mark Adler on rolling CRCs: https://stackoverflow.com/a/40515523
+//
+
+#include "crc32c_hash.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#define CRC32C_HASH_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#ifdef CRC32C_HASH_X86
+    /**
+     * CRC update of `crc` with `data`, with the SSE4.2 `crc32` instruction: 8 bytes at a time, then the rest one by
+     * one. The instruction reads its operand in little-endian order, which is the order the bytes are appended.
+     */
+    __attribute__((target("sse4.2"))) auto update_with_hardware(uint64_t crc, std::string_view data) -> uint64_t
+    {
+        auto i = std::size_t{};
+        for (; i + 8 <= std::size(data); i += 8)
+        {
+            auto block = uint64_t{};
+            std::memcpy(&block, std::data(data) + i, sizeof(block));
+            crc = _mm_crc32_u64(crc, block);
+        }
+        for (; i < std::size(data); ++i)
+            crc = _mm_crc32_u8(static_cast<uint32_t>(crc), static_cast<unsigned char>(data[i]));
+        return crc;
+    }
+#endif
+} // namespace
+
+Crc32cHash::Crc32cHash(std::size_t window_size, bool use_hardware)
+    : m_window_size{ window_size }, m_use_hardware{ use_hardware && is_hardware_supported() }
+{
+    // A byte's contribution is linear in its bits, so only the 8 single-bit bytes are slid past `m_window_size`
+    // zero bytes, and every other byte combines theirs.
+    auto bit_contributions = std::array<uint32_t, 8>{};
+    for (std::size_t bit = 0; bit < 8; ++bit)
+    {
+        auto hash = append(Hash{}, static_cast<char>(1U << bit));
+        for (std::size_t i = 0; i < m_window_size; ++i)
+            hash = append(hash, '\0');
+        bit_contributions[bit] = static_cast<uint32_t>(hash);
+    }
+    for (std::size_t byte = 0; byte < 256; ++byte)
+    {
+        for (std::size_t bit = 0; bit < 8; ++bit)
+        {
+            if ((byte >> bit) & 1)
+                m_pop_table[byte] ^= bit_contributions[bit];
+        }
+    }
+}
+
+auto Crc32cHash::is_hardware_supported() -> bool
+{
+#ifdef CRC32C_HASH_X86
+    return cpu_dispatch::is_supported(cpu_dispatch::IsaLevel::x86_64_v2);
+#else
+    return false;
+#endif
+}
+
+auto Crc32cHash::hash_window(std::string_view window) const -> Hash
+{
+#ifdef CRC32C_HASH_X86
+    if (m_use_hardware)
+        return update_with_hardware(Hash{}, window);
+#endif
+    auto hash = Hash{};
+    for (const auto c : window)
+        hash = append(hash, c);
+    return hash;
+}
@@ -0,0 +1,113 @@
+//
+// CRC-32C (Castagnoli) as a rolling hash.
+// References:
+// Castagnoli, Brauer, Herrmann, "Optimization of cyclic redundancy-check codes with 24 and 32 parity bits"
+// Intel, "Fast CRC Computation for iSCSI Polynomial Using CRC32 Instruction"
+//
+
+#ifndef CRC32C_HASH_HPP
+#define CRC32C_HASH_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "cpu_dispatch.hpp"
+
+/**
+ * `RollingHash` policy: the CRC-32C of the window, without the initial and final inversions of the standard CRC so
+ * that it stays linear over GF(2).
+ * \n
+ * Appending is the usual byte-at-a-time table update. Removing the first byte XORs out its contribution after
+ * `window_size` more bytes, read from a "pop" table, just like `RabinFingerprint`. Whole windows are hashed with the
+ * SSE4.2 `crc32` instruction, 8 bytes at a time, when the CPU has it, and with the table otherwise. Both give the
+ * same hashes.
+ * The hash only has 32 bits, so it collides more often than the 53-bit Rabin fingerprint on large inputs.
+ */
+class Crc32cHash
+{
+public:
+    using Hash = uint64_t;
+
+    // CRC-32C polynomial, bit-reflected (bit 31 is the coefficient of x^0).
+    static constexpr uint32_t polynomial{ 0x82F6'3B78 };
+
+public:
+    /**
+     * Fills the pop table for windows of `window_size`.
+     * @param window_size Size of the window the hash slides with.
+     * @param use_hardware Whether `hash_window` uses the `crc32` instruction. Ignored if the CPU does not have it.
+     *                     By default, when the active ISA level includes it (see `cpu_dispatch`).
+     */
+    explicit Crc32cHash(std::size_t window_size,
+                        bool use_hardware = cpu_dispatch::is_enabled(cpu_dispatch::IsaLevel::x86_64_v2));
+
+    /**
+     * Whether this CPU has the SSE4.2 `crc32` instruction.
+     */
+    static auto is_hardware_supported() -> bool;
+
+    auto get_window_size() const -> std::size_t
+    {
+        return m_window_size;
+    }
+
+    auto uses_hardware() const -> bool
+    {
+        return m_use_hardware;
+    }
+
+    /**
+     * Hash of the window grown by `c` at its end.
+     * @param hash Hash of the window.
+     * @param c Character to append.
+     * @return Updated hash.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        return (hash >> 8) ^ update_table[(hash ^ static_cast<unsigned char>(c)) & 0xFF];
+    }
+
+    /**
+     * Hash of the window without its first character, just after a character was appended to it.
+     * @param hash Hash of the window, of length `window_size + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated hash.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        return hash ^ m_pop_table[static_cast<unsigned char>(first_character)];
+    }
+
+    /**
+     * Hash of a whole window, the same as appending its characters one by one to an empty hash.
+     * @param window Characters to hash.
+     * @return Hash of `window`.
+     */
+    auto hash_window(std::string_view window) const -> Hash;
+
+private:
+    // For each byte: the CRC update of a hash whose low byte, XORed with the appended character, is that byte.
+    static constexpr auto update_table = []
+    {
+        auto table = std::array<uint32_t, 256>{};
+        for (uint32_t byte = 0; byte < 256; ++byte)
+        {
+            auto crc = byte;
+            for (auto bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ ((crc & 1) != 0 ? polynomial : 0);
+            table[byte] = crc;
+        }
+        return table;
+    }();
+
+private:
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{};
+    // Whether `hash_window` uses the `crc32` instruction.
+    bool m_use_hardware{};
+    // For each byte: its contribution to the hash once `m_window_size` bytes were appended after it.
+    std::array<uint32_t, 256> m_pop_table{};
+};
+
+#endif // CRC32C_HASH_HPP
@@ -0,0 +1,123 @@
+//
+// Two polynomial hashes with independent moduli, computed together ("double hashing").
+// References:
+// Codeforces: https://codeforces.com/blog/entry/60445
+// CP-Algorithms: https://cp-algorithms.com/string/string-hashing.html
+//
+
+#ifndef DOUBLE_POLYNOMIAL_HASH_HPP
+#define DOUBLE_POLYNOMIAL_HASH_HPP
+
+#include <cstdint>
+
+/**
+ * `RollingHash` policy: two polynomial hashes of the window, each modulo its own prime below 2^32, packed into a
+ * single 64-bit hash.
+ * \n
+ * Two windows only have the same hash if both lanes collide, so the chance of a false match is about the product of
+ * the chances for each modulus. The moduli are compile-time constants, so no division is left in the loops.
+ */
+class DoublePolynomialHash
+{
+public:
+    using Hash = uint64_t;
+
+    // Both lanes use primes just below 2^32, and different bases, so that they are independent
+    static constexpr uint64_t first_modulo{ 4'294'967'291 };  // 2^32 - 5
+    static constexpr uint64_t second_modulo{ 4'294'967'279 }; // 2^32 - 17
+    static constexpr uint64_t first_base{ 257 };
+    static constexpr uint64_t second_base{ 263 };
+
+    // Lanes for `hash_windows`. Each slide already updates two independent hashes.
+    static constexpr std::size_t interleaved_lanes{ 2 };
+
+public:
+    /**
+     * Precomputes what is needed to hash windows of `window_size`.
+     * @param window_size Size of the window the hash slides with.
+     */
+    explicit DoublePolynomialHash(std::size_t window_size)
+        : m_window_size{ window_size }, m_first_window_base_power{ power(first_base, window_size, first_modulo) },
+          m_second_window_base_power{ power(second_base, window_size, second_modulo) }
+    {
+    }
+
+    auto get_window_size() const -> std::size_t
+    {
+        return m_window_size;
+    }
+
+    /**
+     * Hash of the window grown by `c` at its end.
+     * @param hash Hash of the window.
+     * @param c Character to append.
+     * @return Updated hash.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        const auto char_value = static_cast<uint64_t>(static_cast<unsigned char>(c));
+        // Lanes are below 2^32, so neither the products nor the sums overflow
+        const auto first = (get_first(hash) * first_base + char_value) % first_modulo;
+        const auto second = (get_second(hash) * second_base + char_value) % second_modulo;
+        return pack(first, second);
+    }
+
+    /**
+     * Hash of the window without its first character, just after a character was appended to it.
+     * @param hash Hash of the window, of length `window_size + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated hash.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        const auto char_value = static_cast<uint64_t>(static_cast<unsigned char>(first_character));
+        // Adding the modulo first, so that the subtractions can not underflow
+        const auto first = (get_first(hash) + first_modulo - char_value * m_first_window_base_power % first_modulo) %
+                           first_modulo;
+        const auto second =
+            (get_second(hash) + second_modulo - char_value * m_second_window_base_power % second_modulo) %
+            second_modulo;
+        return pack(first, second);
+    }
+
+private:
+    static auto get_first(Hash hash) -> uint64_t
+    {
+        return hash & 0xFFFF'FFFF;
+    }
+
+    static auto get_second(Hash hash) -> uint64_t
+    {
+        return hash >> 32;
+    }
+
+    static auto pack(uint64_t first, uint64_t second) -> Hash
+    {
+        return (second << 32) | first;
+    }
+
+    /**
+     * Computes `base^exponent` modulo `modulo`, by repeated squaring.
+     * REQUIREMENTS: `modulo` is below 2^32.
+     */
+    static constexpr auto power(uint64_t base, std::size_t exponent, uint64_t modulo) -> uint64_t
+    {
+        auto result = uint64_t{ 1 };
+        for (base %= modulo; exponent > 0; exponent /= 2)
+        {
+            if (exponent % 2 == 1)
+                result = result * base % modulo;
+            base = base * base % modulo;
+        }
+        return result;
+    }
+
+private:
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{};
+    // base^window_size for each lane, the factor of the character leaving the window.
+    uint64_t m_first_window_base_power{ 1 };
+    uint64_t m_second_window_base_power{ 1 };
+};
+
+#endif // DOUBLE_POLYNOMIAL_HASH_HPP
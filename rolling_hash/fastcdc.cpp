@@ -0,0 +1,81 @@
+//
+// FastCDC content-defined chunking, with a Gear rolling hash.
+// References:
+// Wen Xia et al., "FastCDC: a Fast and Efficient Content-Defined Chunking Approach for Data Deduplication"
+// Wen Xia et al., "Ddelta: A Deduplication-Inspired Fast Delta Compression Approach" (Gear hash)
+//
+
+#include "fastcdc.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace fastcdc
+{
+    namespace
+    {
+        /**
+         * Mask of the `bits` highest bits. The Gear hash mixes its top bits best: they depend on the last 64 bytes.
+         */
+        auto make_mask(int bits) -> uint64_t
+        {
+            bits = std::clamp(bits, 0, 64);
+            return bits == 0 ? 0 : ~uint64_t{} << (64 - bits);
+        }
+    } // namespace
+
+    auto make_parameters(const std::size_t average_size) -> Parameters
+    {
+        if (average_size == 0)
+            throw std::runtime_error("The average chunk size must be at least 1.");
+
+        // A boundary every 2^bits bytes on random data. Normalization level 2: a mask 4 times harder before the
+        // average, and 4 times easier after it.
+        const auto bits = static_cast<int>(std::bit_width(average_size)) - 1;
+        auto result = Parameters{};
+        result.minimum_size = std::max<std::size_t>(average_size / 4, 1);
+        result.average_size = average_size;
+        result.maximum_size = average_size * 4;
+        result.strict_mask = make_mask(bits + 2);
+        result.loose_mask = make_mask(bits - 2);
+        return result;
+    }
+
+    auto find_chunk_end(const std::string_view input, const Parameters& parameters) -> std::size_t
+    {
+        if (std::size(input) <= parameters.minimum_size)
+            return std::size(input);
+
+        const auto end = std::min(std::size(input), parameters.maximum_size);
+        const auto normal_end = std::min(end, parameters.average_size);
+        auto hash = uint64_t{};
+        auto i = parameters.minimum_size;
+        for (; i < normal_end; ++i)
+        {
+            hash = (hash << 1) + gear_table[static_cast<unsigned char>(input[i])];
+            if ((hash & parameters.strict_mask) == 0)
+                return i + 1;
+        }
+        for (; i < end; ++i)
+        {
+            hash = (hash << 1) + gear_table[static_cast<unsigned char>(input[i])];
+            if ((hash & parameters.loose_mask) == 0)
+                return i + 1;
+        }
+        return end;
+    }
+
+    auto split(std::string_view input, const Parameters& parameters) -> std::vector<std::size_t>
+    {
+        auto result = std::vector<std::size_t>{};
+        result.reserve(std::size(input) / parameters.average_size + 1);
+        while (!input.empty())
+        {
+            const auto length = find_chunk_end(input, parameters);
+            result.push_back(length);
+            input.remove_prefix(length);
+        }
+        return result;
+    }
+} // namespace fastcdc
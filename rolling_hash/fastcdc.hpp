@@ -0,0 +1,81 @@
+//
+// FastCDC content-defined chunking, with a Gear rolling hash.
+// References:
+// Wen Xia et al., "FastCDC: a Fast and Efficient Content-Defined Chunking Approach for Data Deduplication":
+//          https://www.usenix.org/conference/atc16/technical-sessions/presentation/xia
+//
+
+#ifndef FASTCDC_HPP
+#define FASTCDC_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace fastcdc
+{
+    /**
+     * Random value added to the Gear hash for each byte. Generated at compile time with a fixed seed (through
+     * splitmix64), so that every build cuts the same chunks, and signatures can be shared between them.
+     */
+    inline constexpr auto gear_table = []
+    {
+        auto result = std::array<uint64_t, 256>{};
+        auto state = uint64_t{ 0x2545F4914F6CDD1D };
+        for (auto& value : result)
+        {
+            state += 0x9E3779B97F4A7C15;
+            auto mixed = state;
+            mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EB;
+            value = mixed ^ (mixed >> 31);
+        }
+        return result;
+    }();
+
+    // Sizes the chunks are cut at, and the masks deciding where.
+    struct Parameters
+    {
+        // No chunk is cut shorter than this, except the last one. The bytes up to it are not even hashed.
+        std::size_t minimum_size{};
+        // Chunks are about this long on random data.
+        std::size_t average_size{};
+        // Chunks are cut here if no boundary was found before.
+        std::size_t maximum_size{};
+        // Boundaries are where the Gear hash ANDed with the mask is zero. The strict mask (more bits) is used before
+        // `average_size`, the loose one after, which packs the chunk sizes around the average ("normalized
+        // chunking").
+        uint64_t strict_mask{};
+        uint64_t loose_mask{};
+    };
+
+    /**
+     * Parameters for chunks of `average_size` on average, between a quarter and four times that size.
+     * @param average_size Expected chunk size, at least 1.
+     * @return Parameters to pass to `find_chunk_end` and `split`.
+     */
+    auto make_parameters(std::size_t average_size) -> Parameters;
+
+    /**
+     * Length of the first chunk of `input`.
+     * \n
+     * The Gear hash shifts left by one bit and adds the incoming byte's random value, so each byte leaves the top
+     * bits after 64 more bytes: boundaries only depend on the content right before them. An edit thus only moves
+     * the boundaries next to it, and the chunks after it are the same as before.
+     * @param input Input to cut, starting at a chunk boundary.
+     * @param parameters Chunk sizes and masks.
+     * @return Size of the first chunk, between 1 and `parameters.maximum_size` (0 only for an empty input).
+     */
+    auto find_chunk_end(std::string_view input, const Parameters& parameters) -> std::size_t;
+
+    /**
+     * Cuts the whole of `input` into chunks.
+     * @param input Input to cut.
+     * @param parameters Chunk sizes and masks.
+     * @return Length of each chunk, in order. They add up to the size of `input`.
+     */
+    auto split(std::string_view input, const Parameters& parameters) -> std::vector<std::size_t>;
+} // namespace fastcdc
+
+#endif // FASTCDC_HPP
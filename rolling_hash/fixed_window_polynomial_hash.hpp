@@ -0,0 +1,132 @@
+//
+// Polynomial hash specialized for the chunk sizes used in practice (see `FileDiff`).
+//
+
+#ifndef FIXED_WINDOW_POLYNOMIAL_HASH_HPP
+#define FIXED_WINDOW_POLYNOMIAL_HASH_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "polynomial_hash.hpp"
+
+/**
+ * `RollingHash` policy: the same hash as `PolynomialHash` modulo `PolynomialHash::mersenne_modulo`, for a window
+ * size known at compile time.
+ * \n
+ * Every power of the base it needs is a compile-time constant, so building one costs nothing and the window
+ * length is folded into the loops. The first window is hashed in blocks of a few characters, whose products are
+ * independent of each other, instead of one long chain of multiplications.
+ */
+template <uint64_t AlphabetBase, std::size_t WindowSize>
+class FixedWindowPolynomialHash
+{
+public:
+    using Hash = PolynomialHash::Hash;
+
+private:
+    // Characters hashed together by `hash_window`.
+    static constexpr std::size_t block_size{ 8 };
+
+    static_assert(AlphabetBase < PolynomialHash::mersenne_modulo);
+    static_assert(WindowSize % block_size == 0, "The window must be made of whole blocks.");
+
+public:
+    auto get_window_size() const -> std::size_t
+    {
+        return WindowSize;
+    }
+
+    /**
+     * Hash of the window grown by `c` at its end.
+     * @param hash Hash of the window.
+     * @param c Character to append.
+     * @return Updated hash.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        hash = PolynomialHash::multiply_mersenne(hash, AlphabetBase) + get_ascii_value_from_char(c);
+        return hash >= PolynomialHash::mersenne_modulo ? hash - PolynomialHash::mersenne_modulo : hash;
+    }
+
+    /**
+     * Hash of the window without its first character, just after a character was appended to it.
+     * @param hash Hash of the window, of length `WindowSize + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated hash.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        const auto char_contribution =
+            PolynomialHash::multiply_mersenne(get_ascii_value_from_char(first_character), window_base_power);
+        // Both values are below the modulo, so adding it once is enough for the subtraction not to underflow
+        if (char_contribution > hash)
+            hash += PolynomialHash::mersenne_modulo;
+        return hash - char_contribution;
+    }
+
+    /**
+     * Hash of a whole window, the same as appending each of its characters to the empty window.
+     * REQUIREMENTS: `window` is of length `WindowSize`.
+     * @param window Characters of the window.
+     * @return Hash of the window.
+     */
+    auto hash_window(std::string_view window) const -> Hash
+    {
+        auto hash = Hash{};
+        for (std::size_t block_start = 0; block_start < WindowSize; block_start += block_size)
+        {
+            // Each character of the block times its power of the base. The products do not depend on each other,
+            // and their sum (below 2^72) is only reduced once.
+            auto block_value = PolynomialHash::UInt128{};
+            for (std::size_t i = 0; i < block_size; ++i)
+            {
+                const auto char_value = get_ascii_value_from_char(window[block_start + i]);
+                block_value += static_cast<PolynomialHash::UInt128>(char_value) * block_base_powers[block_size - 1 - i];
+            }
+            // "Shift the hash to the left" by a whole block at once
+            hash = PolynomialHash::multiply_mersenne(hash, block_base_powers[block_size]) +
+                   PolynomialHash::reduce_mersenne(block_value);
+            if (hash >= PolynomialHash::mersenne_modulo)
+                hash -= PolynomialHash::mersenne_modulo;
+        }
+        return hash;
+    }
+
+private:
+    /**
+     * Computes `AlphabetBase^exponent` modulo `PolynomialHash::mersenne_modulo`, at compile time.
+     */
+    static constexpr auto base_power(std::size_t exponent) -> uint64_t
+    {
+        auto result = uint64_t{ 1 };
+        for (std::size_t i = 0; i < exponent; ++i)
+            result = PolynomialHash::multiply_mersenne(result, AlphabetBase);
+        return result;
+    }
+
+    /**
+     * Get ascii value from a character.
+     * @param c Character to get value from.
+     * @return Ascii value as unsigned.
+     */
+    static auto get_ascii_value_from_char(char c) -> uint64_t
+    {
+        return static_cast<uint64_t>(static_cast<unsigned char>(c));
+    }
+
+private:
+    // AlphabetBase^0 ... AlphabetBase^block_size, used to hash blocks.
+    static constexpr std::array<uint64_t, block_size + 1> block_base_powers = []
+    {
+        auto result = std::array<uint64_t, block_size + 1>{};
+        for (std::size_t i = 0; i <= block_size; ++i)
+            result[i] = base_power(i);
+        return result;
+    }();
+    // AlphabetBase^WindowSize, the factor of the character leaving the window.
+    static constexpr uint64_t window_base_power{ base_power(WindowSize) };
+};
+
+#endif // FIXED_WINDOW_POLYNOMIAL_HASH_HPP
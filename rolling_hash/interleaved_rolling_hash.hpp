@@ -0,0 +1,109 @@
+//
+// Hashing every window of an input with several independent rolling hashes advancing in lockstep.
+//
+
+#ifndef INTERLEAVED_ROLLING_HASH_HPP
+#define INTERLEAVED_ROLLING_HASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include "rolling_hash.hpp"
+
+/**
+ * Computes the hash of every window of `input`: `output[i]` is the hash of the window starting at `i`.
+ * \n
+ * Sliding a single window is latency-bound: each hash depends on the previous one, so the multiplier (or table
+ * lookups) sit idle most of the time. Here the windows are split into `Lanes` contiguous regions, each one with its
+ * own rolling hash, and all of them slide by one byte per step. Their updates do not depend on each other, so the
+ * CPU overlaps them. Each region is seeded by hashing its first window from scratch, so the hashes are the same as
+ * sliding a single window through the whole input.
+ * REQUIREMENTS: `output` has exactly one element per window of `input`.
+ * @param shared_policy How to compute the hash, see `RollingHashPolicy`.
+ * @param input Input to hash, at least one window long.
+ * @param output Where to write the hash of each window.
+ */
+template <std::size_t Lanes, RollingHashPolicy Policy>
+auto hash_windows_interleaved(const Policy& shared_policy, std::string_view input,
+                              std::span<typename Policy::Hash> output) -> void
+{
+    // Our own copy: the hashes written to `output` could otherwise alias the policy's parameters, which would then be
+    // read again from memory for every window
+    const auto policy = shared_policy;
+    static_assert(Lanes > 0);
+    const auto window_size = policy.get_window_size();
+    if (std::size(input) < window_size || std::size(output) != std::size(input) - window_size + 1)
+        throw std::runtime_error("There must be one output for each window of input.");
+
+    // Each lane hashes its first window, then slides `lane_slides` times. The windows left over by the division
+    // are slid through by the last lane on its own.
+    const auto lane_length = std::size(output) / Lanes;
+    // Seeding a lane costs about a window of appends, which is only worth it if the lane then slides further
+    if (Lanes == 1 || lane_length < window_size)
+    {
+        auto hasher = RollingHash(policy, input, 0);
+        output[0] = hasher.get_current_hash();
+        hasher.slide_many(output.subspan(1));
+        return;
+    }
+    const auto lane_slides = lane_length - 1;
+
+    auto hashes = std::array<typename Policy::Hash, Lanes>{};
+    for (std::size_t lane = 0; lane < Lanes; ++lane)
+    {
+        hashes[lane] = compute_window_hash(policy, input.substr(lane * lane_length, window_size));
+        output[lane * lane_length] = hashes[lane];
+    }
+    for (std::size_t step = 0; step < lane_slides; ++step)
+    {
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            // The window of this lane moves from starting at `window_start` to starting at `window_start + 1`
+            const auto window_start = lane * lane_length + step;
+            const auto appended = policy.append(hashes[lane], input[window_start + window_size]);
+            hashes[lane] = policy.remove_first(appended, input[window_start]);
+            output[window_start + 1] = hashes[lane];
+        }
+    }
+
+    const auto last_window_done = Lanes * lane_length - 1;
+    if (last_window_done + 1 < std::size(output))
+    {
+        auto hasher = RollingHash(policy, input, last_window_done);
+        hasher.slide_many(output.subspan(last_window_done + 1));
+    }
+}
+
+/**
+ * How many lanes `hash_windows` uses for `Policy`.
+ * \n
+ * Defaults to 4, which keeps the multiplier or table lookups busy on current CPUs. A policy can ask for another
+ * number with a `static constexpr std::size_t interleaved_lanes` member, e.g. when its data-dependent branches are
+ * mispredicted with more lanes.
+ */
+template <RollingHashPolicy Policy>
+constexpr auto get_interleaved_lanes() -> std::size_t
+{
+    if constexpr (requires { Policy::interleaved_lanes; })
+        return Policy::interleaved_lanes;
+    else
+        return 4;
+}
+
+/**
+ * Computes the hash of every window of `input`, as `hash_windows_interleaved` with the policy's number of lanes.
+ * REQUIREMENTS: `output` has exactly one element per window of `input`.
+ * @param policy How to compute the hash, see `RollingHashPolicy`.
+ * @param input Input to hash, at least one window long.
+ * @param output Where to write the hash of each window.
+ */
+template <RollingHashPolicy Policy>
+auto hash_windows(const Policy& policy, std::string_view input, std::span<typename Policy::Hash> output) -> void
+{
+    hash_windows_interleaved<get_interleaved_lanes<Policy>()>(policy, input, output);
+}
+
+#endif // INTERLEAVED_ROLLING_HASH_HPP
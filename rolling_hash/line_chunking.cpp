@@ -0,0 +1,129 @@
+//
+// Chunking text at line boundaries, where the content says.
+// The newline scans compare 16 bytes at once, as memchr does. SSE2 is part of x86-64, so they need no runtime
+// dispatch.
+//
+
+#include "line_chunking.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "fastcdc.hpp"
+
+#if defined(__SSE2__)
+#define LINE_CHUNKING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace line_chunking
+{
+    namespace
+    {
+#ifdef LINE_CHUNKING_SSE2
+        /**
+         * Bit i is set if byte i of the 16 at `data` is a newline.
+         */
+        auto newline_mask(const char* data) -> unsigned
+        {
+            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+        }
+#endif
+    } // namespace
+
+    auto make_parameters(const std::size_t average_size) -> Parameters
+    {
+        if (average_size == 0)
+            throw std::runtime_error("The average chunk size must be at least 1.");
+
+        auto result = Parameters{};
+        result.minimum_size = average_size / 4;
+        result.average_size = average_size;
+        result.maximum_size = average_size * 4;
+        // Cut points are 2^bits bytes apart on random data, after the minimum size
+        const auto bits = static_cast<int>(std::bit_width(average_size - result.minimum_size)) - 1;
+        result.mask = bits <= 0 ? 0 : ~uint64_t{} << (64 - bits);
+        return result;
+    }
+
+    auto find_first_newline(const std::string_view input) -> std::size_t
+    {
+        auto i = std::size_t{};
+#ifdef LINE_CHUNKING_SSE2
+        for (; i + 16 <= std::size(input); i += 16)
+        {
+            if (const auto mask = newline_mask(std::data(input) + i); mask != 0)
+                return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+#endif
+        for (; i < std::size(input); ++i)
+        {
+            if (input[i] == '\n')
+                return i;
+        }
+        return std::string_view::npos;
+    }
+
+    auto find_last_newline(const std::string_view input) -> std::size_t
+    {
+        // `end` is one past the bytes left to scan, going backwards
+        auto end = std::size(input);
+#ifdef LINE_CHUNKING_SSE2
+        for (; end >= 16; end -= 16)
+        {
+            if (const auto mask = newline_mask(std::data(input) + end - 16); mask != 0)
+                return end - 16 + static_cast<std::size_t>(std::bit_width(mask)) - 1;
+        }
+#endif
+        for (; end > 0; --end)
+        {
+            if (input[end - 1] == '\n')
+                return end - 1;
+        }
+        return std::string_view::npos;
+    }
+
+    auto find_chunk_end(const std::string_view input, const Parameters& parameters) -> std::size_t
+    {
+        if (std::size(input) <= parameters.minimum_size)
+            return std::size(input);
+
+        const auto limit = std::min(std::size(input), parameters.maximum_size);
+        // Unlike FastCDC, the bytes before the minimum size are hashed as well, so that the hash of every cut point
+        // covers the same 64 bytes before it wherever the chunk started
+        auto hash = uint64_t{};
+        for (std::size_t i = 0; i < limit; ++i)
+        {
+            hash = (hash << 1) + fastcdc::gear_table[static_cast<unsigned char>(input[i])];
+            if (i >= parameters.minimum_size && (hash & parameters.mask) == 0)
+            {
+                const auto newline = find_first_newline(input.substr(i, limit - i));
+                if (newline == std::string_view::npos)
+                    break;
+                return i + newline + 1;
+            }
+        }
+        // An input of `maximum_size` bytes or more may go on, so it is cut the same way whatever follows
+        if (std::size(input) < parameters.maximum_size)
+            return std::size(input);
+        // Too long: cut at the last line that fits, or in the middle of a line longer than the maximum
+        const auto newline =
+            find_last_newline(input.substr(parameters.minimum_size, limit - parameters.minimum_size));
+        return newline == std::string_view::npos ? limit : parameters.minimum_size + newline + 1;
+    }
+
+    auto split(std::string_view input, const Parameters& parameters) -> std::vector<std::size_t>
+    {
+        auto result = std::vector<std::size_t>{};
+        result.reserve(std::size(input) / parameters.average_size + 1);
+        while (!input.empty())
+        {
+            const auto length = find_chunk_end(input, parameters);
+            result.push_back(length);
+            input.remove_prefix(length);
+        }
+        return result;
+    }
+} // namespace line_chunking
@@ -0,0 +1,74 @@
+//
+// Chunking text at line boundaries, where the content says.
+//
+
+#ifndef LINE_CHUNKING_HPP
+#define LINE_CHUNKING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace line_chunking
+{
+    // Sizes the chunks are cut at, and the mask deciding where.
+    struct Parameters
+    {
+        // No chunk is cut shorter than this, except the last one.
+        std::size_t minimum_size{};
+        // Chunks are about this long on text with short lines.
+        std::size_t average_size{};
+        // Chunks are cut at the last newline before this size if no boundary was found before.
+        std::size_t maximum_size{};
+        // A line ends a chunk if the Gear hash ANDed with the mask is zero at any of its bytes.
+        uint64_t mask{};
+    };
+
+    /**
+     * Parameters for chunks of `average_size` on average, between a quarter and four times that size.
+     * @param average_size Size the chunks aim for, at least 1.
+     * @return Parameters to pass to `find_chunk_end` and `split`.
+     */
+    auto make_parameters(std::size_t average_size) -> Parameters;
+
+    /**
+     * Position of the first '\n' in `input`, 16 bytes at a time with SSE2 where available.
+     * @return Its index, or `std::string_view::npos` if there is none.
+     */
+    auto find_first_newline(std::string_view input) -> std::size_t;
+
+    /**
+     * Position of the last '\n' in `input`, 16 bytes at a time with SSE2 where available.
+     * @return Its index, or `std::string_view::npos` if there is none.
+     */
+    auto find_last_newline(std::string_view input) -> std::size_t;
+
+    /**
+     * Length of the first chunk of `input`: the Gear hash of `fastcdc` picks content-defined cut points, and each
+     * one is snapped forward to the end of its line.
+     * \n
+     * Chunks thus hold whole lines. Cut points only depend on the 64 bytes before them, with no normalization
+     * counting from the start of the chunk, so an edited line only changes the chunk it is in: the next line that
+     * ends a chunk still does. Snapping fixed offsets to the closest newline would not do that, as after an inserted
+     * line every later chunk would stay one line off.
+     * \n
+     * As with `fastcdc::find_chunk_end`, the result only depends on the first `maximum_size` bytes of `input`, so a
+     * window of at least that many bytes into a longer input is cut as the whole input would be. Only an input
+     * shorter than that is taken to end where it does.
+     * @param input Input to cut, starting at a chunk boundary.
+     * @param parameters Chunk sizes and mask.
+     * @return Size of the first chunk (0 only for an empty input).
+     */
+    auto find_chunk_end(std::string_view input, const Parameters& parameters) -> std::size_t;
+
+    /**
+     * Cuts the whole of `input` into chunks.
+     * @param input Input to cut.
+     * @param parameters Chunk sizes and mask.
+     * @return Length of each chunk, in order. They add up to the size of `input`.
+     */
+    auto split(std::string_view input, const Parameters& parameters) -> std::vector<std::size_t>;
+} // namespace line_chunking
+
+#endif // LINE_CHUNKING_HPP
@@ -0,0 +1,29 @@
+//
+// Created by matheus on 24/07/22.
+// Implementation References:
+// Algorithms Live: https://www.youtube.com/watch?v=rA1ZevamGDc
+// MIT OCW: https://www.youtube.com/watch?v=w6nuXg0BISo
+//          https://www.youtube.com/watch?v=BRO7mVIFt08
+// Codeforces: https://codeforces.com/blog/entry/60445
+// CP-Algorithms: https://cp-algorithms.com/string/string-hashing.html
+//
+
+#include "polynomial_hash.hpp"
+
+#include <limits>
+
+PolynomialHash::PolynomialHash(uint64_t alphabet_base, uint64_t modulo, std::size_t window_size)
+    : m_alphabet_base{ alphabet_base }, m_modulo{ modulo }, m_window_size{ window_size },
+      m_uses_mersenne_modulo{ modulo == mersenne_modulo },
+      m_uses_wide_modulo{ !m_uses_mersenne_modulo && modulo > std::numeric_limits<uint32_t>::max() },
+      m_barrett_factor{ std::numeric_limits<uint64_t>::max() / modulo }
+{
+    // Precompute base^window_size for performance reasons, by repeated squaring.
+    auto power = m_alphabet_base % m_modulo;
+    for (auto exponent = m_window_size; exponent > 0; exponent /= 2)
+    {
+        if (exponent % 2 == 1)
+            m_window_base_power = multiply_modulo(m_window_base_power, power);
+        power = multiply_modulo(power, power);
+    }
+}
@@ -0,0 +1,177 @@
+//
+// Created by matheus on 24/07/22.
+//
+
+#ifndef POLYNOMIAL_HASH_HPP
+#define POLYNOMIAL_HASH_HPP
+
+#include <cstdint>
+
+/**
+ * `RollingHash` policy: polynomial hash of the window, modulo a prime.
+ * \n
+ * The hash of c_1 ... c_n is c_1 * base^(n-1) + c_2 * base^(n-2) + ... + c_n, modulo `modulo`.
+ */
+class PolynomialHash
+{
+public:
+    using Hash = uint64_t;
+
+    // The Mersenne prime 2^61 - 1. When used as `modulo`, products are reduced with shifts and additions instead
+    // of divisions, and hashes use (almost) the whole 64 bits.
+    static constexpr uint64_t mersenne_modulo{ (uint64_t{ 1 } << 61) - 1 };
+
+    // Lanes for `hash_windows`. Reductions are branches, which are mispredicted too often with more lanes.
+    static constexpr std::size_t interleaved_lanes{ 2 };
+
+    // GCC and Clang extension, which maps to the single 64x64 -> 128 bits multiply instruction.
+    __extension__ using UInt128 = unsigned __int128;
+
+public:
+    /**
+     * Precomputes what is needed to hash windows of `window_size`.
+     * @param alphabet_base Base to use for hashing computations. Should be bigger than the alphabet.
+     * @param modulo Modulo to use for hashing. Should be prime, bigger than the base and below 2^63. Products are
+     * fastest modulo `mersenne_modulo` or primes below 2^32; any other modulo takes a 128-bit division.
+     * @param window_size Size of the window the hash slides with.
+     */
+    PolynomialHash(uint64_t alphabet_base, uint64_t modulo, std::size_t window_size);
+
+    auto get_window_size() const -> std::size_t
+    {
+        return m_window_size;
+    }
+
+    /**
+     * Hash of the window grown by `c` at its end.
+     * @param hash Hash of the window.
+     * @param c Character to append.
+     * @return Updated hash.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        const auto char_value = get_ascii_value_from_char(c);
+        // "Shift the hash to the left"
+        hash = multiply_modulo(hash, m_alphabet_base);
+
+        hash += char_value;
+        // Both values were below m_modulo, so a single subtraction brings the sum back into the valid range.
+        if (hash >= m_modulo)
+            hash -= m_modulo;
+        return hash;
+    }
+
+    /**
+     * Hash of the window without its first character, just after a character was appended to it.
+     * @param hash Hash of the window, of length `window_size + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated hash.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        const auto char_value = get_ascii_value_from_char(first_character);
+
+        // We must remove the contribution of this value in our hash
+        // It was appended `m_window_size` characters ago (we have just appended one more)
+        const auto char_contribution = multiply_modulo(char_value, m_window_base_power);
+        // We need to be careful with underflow here, as we are using unsigned integers
+        if (char_contribution > hash)
+        {
+            // As both values involved are between 0 and (m_modulo - 1)
+            // It suffices to add a m_modulo to the current_hash
+            // Then the result will not be negative
+            hash += m_modulo;
+            // Note that here hash may be bigger than m_modulo (breaks our invariant)
+            // But our subtraction will fix it
+        }
+        hash -= char_contribution;
+        // The result is between 0 and (m_modulo - 1) again, no need to take the modulo.
+        return hash;
+    }
+
+    /**
+     * Computes `lhs * rhs` modulo `mersenne_modulo`, with a 128-bit product and shift-add reduction.
+     * REQUIREMENTS: both values are below `mersenne_modulo`.
+     */
+    static constexpr auto multiply_mersenne(uint64_t lhs, uint64_t rhs) -> uint64_t
+    {
+        // Both values are below 2^61, so the product fits in 122 bits.
+        return reduce_mersenne(static_cast<UInt128>(lhs) * rhs);
+    }
+
+    /**
+     * Computes `value` modulo `mersenne_modulo` without any division.
+     * REQUIREMENTS: `value` is below 2^122.
+     */
+    static constexpr auto reduce_mersenne(UInt128 value) -> uint64_t
+    {
+        // As 2^61 = 1 (mod 2^61 - 1), the bits above the 61st can simply be added to the ones below it.
+        // No division is needed.
+        const auto low_bits = static_cast<uint64_t>(value) & mersenne_modulo;
+        const auto high_bits = static_cast<uint64_t>(value >> 61);
+        // Both parts are below 2^61, so one subtraction is enough to get back into the valid range.
+        const auto folded = low_bits + high_bits;
+        return folded >= mersenne_modulo ? folded - mersenne_modulo : folded;
+    }
+
+private:
+    /**
+     * Computes `lhs * rhs` modulo `m_modulo`.
+     * REQUIREMENTS: both values are below `m_modulo`.
+     */
+    auto multiply_modulo(uint64_t lhs, uint64_t rhs) const -> uint64_t
+    {
+        // This branch always goes the same way for a given structure, so it is essentially free.
+        if (m_uses_mersenne_modulo)
+            return multiply_mersenne(lhs, rhs);
+        // Above 2^32, the product may not fit in 64 bits.
+        if (m_uses_wide_modulo)
+            return static_cast<uint64_t>(static_cast<UInt128>(lhs) * rhs % m_modulo);
+        return reduce_barrett(lhs * rhs);
+    }
+
+    /**
+     * Computes `value` modulo `m_modulo` with Barrett reduction: the quotient is estimated by multiplying with the
+     * precomputed `m_barrett_factor` instead of dividing, which is several times faster than a hardware division.
+     * REQUIREMENTS: `value` is below `m_modulo`^2 (so below 2^64).
+     */
+    auto reduce_barrett(uint64_t value) const -> uint64_t
+    {
+        // The estimate is either the quotient or one less than it, so at most one correction is needed.
+        const auto quotient = static_cast<uint64_t>((static_cast<UInt128>(value) * m_barrett_factor) >> 64);
+        const auto remainder = value - quotient * m_modulo;
+        return remainder >= m_modulo ? remainder - m_modulo : remainder;
+    }
+
+    /**
+     * Get ascii value from a character.
+     * @param c Character to get value from.
+     * @return Ascii value as unsigned.
+     */
+    static auto get_ascii_value_from_char(char c) -> uint64_t
+    {
+        // Going through unsigned char, so that bytes above 127 are not sign-extended into huge values.
+        return static_cast<uint64_t>(static_cast<unsigned char>(c));
+    }
+
+private:
+    // Base for hashing. 257 is good for ASCII values, as we are using in file diff.
+    uint64_t m_alphabet_base{ 257 };
+    // Mod for hashing. Either a prime which is not too big (we have room for operations as we use 64 bits), but
+    // big enough so we do not expect many collisions, or the Mersenne prime.
+    uint64_t m_modulo{ mersenne_modulo };
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{ 3 };
+    // Whether `m_modulo` is `mersenne_modulo`, which allows a division-free reduction.
+    bool m_uses_mersenne_modulo{ true };
+    // Whether `m_modulo` is any other modulo of 2^32 or more, for which products need 128 bits.
+    bool m_uses_wide_modulo{ false };
+    // floor((2^64 - 1) / m_modulo), for reducing modulo any other `m_modulo` without division.
+    uint64_t m_barrett_factor{};
+    // For efficiency purposes, we precompute the only base power we need: base^window_size, the factor of the
+    // character leaving the window. It's possible to precompute because we know the fixed window size.
+    // Being a single value, the policy is cheap to build and to copy.
+    uint64_t m_window_base_power{ 1 };
+};
+
+#endif // POLYNOMIAL_HASH_HPP
@@ -0,0 +1,55 @@
+//
+// Rabin fingerprints.
+// References:
+// Michael O. Rabin, "Fingerprinting by random polynomials": http://www.xmailserver.org/rabin.pdf
+// Andrei Z. Broder, "Some applications of Rabin's fingerprinting method"
+// LBFS, "A Low-bandwidth Network File System": https://pdos.csail.mit.edu/papers/lbfs:sosp01/lbfs.pdf
+//
+
+#include "rabin_fingerprint.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+RabinFingerprint::RabinFingerprint(uint64_t polynomial, std::size_t window_size)
+    : m_window_size{ window_size }, m_polynomial{ polynomial },
+      m_degree{ static_cast<int>(std::bit_width(polynomial)) - 1 }
+{
+    if (m_degree < 9 || m_degree > 63)
+        throw std::runtime_error("The polynomial must have a degree between 9 and 63.");
+
+    // Multiplies `value` (of degree smaller than the polynomial's) by x, modulo the polynomial.
+    const auto multiply_by_x = [this](uint64_t value)
+    {
+        value <<= 1;
+        if ((value >> m_degree) & 1)
+            value ^= m_polynomial;
+        return value;
+    };
+
+    // Multiplies `byte` (as a polynomial) by `factor`, modulo the polynomial. Horner's method over its bits.
+    const auto multiply_byte = [&multiply_by_x](uint64_t byte, uint64_t factor)
+    {
+        auto result = uint64_t{};
+        for (auto bit = 7; bit >= 0; --bit)
+        {
+            result = multiply_by_x(result);
+            if ((byte >> bit) & 1)
+                result ^= factor;
+        }
+        return result;
+    };
+
+    // x^degree is congruent to the polynomial without its leading term.
+    const auto x_to_the_degree = m_polynomial ^ (uint64_t{ 1 } << m_degree);
+    for (uint64_t byte = 0; byte < 256; ++byte)
+        m_push_table[byte] = (byte << m_degree) ^ multiply_byte(byte, x_to_the_degree);
+
+    // A byte leaving the window was multiplied by x^8 once for every one of the `m_window_size` bytes after it.
+    // Appending zero bytes to 1 computes exactly that power.
+    auto x_to_the_window = Hash{ 1 };
+    for (std::size_t i = 0; i < m_window_size; ++i)
+        x_to_the_window = append(x_to_the_window, '\0');
+    for (uint64_t byte = 0; byte < 256; ++byte)
+        m_pop_table[byte] = multiply_byte(byte, x_to_the_window);
+}
@@ -0,0 +1,79 @@
+//
+// Rabin fingerprints, from Michael O. Rabin's "Fingerprinting by random polynomials".
+//
+
+#ifndef RABIN_FINGERPRINT_HPP
+#define RABIN_FINGERPRINT_HPP
+
+#include <array>
+#include <cstdint>
+
+/**
+ * `RollingHash` policy: the window's bits, read as a polynomial over GF(2), modulo an irreducible polynomial.
+ * \n
+ * Appending and removing bytes are table-driven: a "push" table folds the byte shifted out of the top of the
+ * fingerprint back into it, and a "pop" table holds the contribution of each byte `window_size` positions ago.
+ * Sliding then takes a couple of shifts, XORs and table lookups, with no multiplication nor modulo.
+ * For a randomly chosen irreducible polynomial of degree k, two different windows of n bits collide with
+ * probability at most n / 2^(k - 1), whatever their contents.
+ */
+class RabinFingerprint
+{
+public:
+    using Hash = uint64_t;
+
+    // An irreducible polynomial of degree 53 over GF(2) (bit i is the coefficient of x^i).
+    static constexpr uint64_t default_polynomial{ 0x3DA3358B4DC173 };
+
+public:
+    /**
+     * Fills the tables for `polynomial` and windows of `window_size`.
+     * @param polynomial Irreducible polynomial to use, of degree between 9 and 63 (e.g. `default_polynomial`).
+     * @param window_size Size of the window the fingerprint slides with.
+     */
+    RabinFingerprint(uint64_t polynomial, std::size_t window_size);
+
+    auto get_window_size() const -> std::size_t
+    {
+        return m_window_size;
+    }
+
+    /**
+     * Fingerprint of the window grown by `c` at its end.
+     * @param hash Fingerprint of the window.
+     * @param c Character to append.
+     * @return Updated fingerprint.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        // Multiply by x^8 and add the new byte. The byte shifted above the degree is folded back by the table.
+        const auto top_byte = hash >> (m_degree - 8);
+        return ((hash << 8) | static_cast<unsigned char>(c)) ^ m_push_table[top_byte];
+    }
+
+    /**
+     * Fingerprint of the window without its first character, just after a character was appended to it.
+     * @param hash Fingerprint of the window, of length `window_size + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated fingerprint.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        // Addition over GF(2) is XOR, so removing a contribution is XORing it again.
+        return hash ^ m_pop_table[static_cast<unsigned char>(first_character)];
+    }
+
+private:
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{};
+    // Irreducible polynomial, and its degree.
+    uint64_t m_polynomial{};
+    int m_degree{};
+    // For each top byte shifted out of the fingerprint: that byte times x^degree, modulo the polynomial, plus the
+    // byte itself at its original position (so that XORing cancels it out).
+    std::array<uint64_t, 256> m_push_table{};
+    // For each byte: its contribution to the fingerprint once `m_window_size` bytes were appended after it.
+    std::array<uint64_t, 256> m_pop_table{};
+};
+
+#endif // RABIN_FINGERPRINT_HPP
@@ -0,0 +1,95 @@
+//
+// rsync's rolling checksum, from Andrew Tridgell's Ph.D. thesis (section 3.2.2) and the rsync tech report.
+// References:
+// Andrew Tridgell's Ph.D. thesis: https://www.samba.org/~tridge/phd_thesis.pdf
+// rsync tech report: https://rsync.samba.org/tech_report/node3.html
+//
+
+#ifndef ROLLING_CHECKSUM_HPP
+#define ROLLING_CHECKSUM_HPP
+
+#include <cstdint>
+
+/**
+ * `RollingHash` policy: the two-sum weak checksum used by rsync (similar to Adler-32).
+ * \n
+ * For a window X_k ... X_l, `a` is the sum of the bytes and `b` is the sum of each byte weighted by its distance
+ * to the end of the window, both modulo 2^32. The hash is `b` in the high half and `a` in the low half.
+ * Sliding only takes additions and subtractions (no multiplication by a power nor modulo), which makes it cheaper
+ * than `PolynomialHash`, at the price of a weaker hash.
+ */
+class RollingChecksum
+{
+public:
+    using Hash = uint64_t;
+
+public:
+    /**
+     * @param window_size Size of the window the checksum slides with.
+     */
+    explicit RollingChecksum(std::size_t window_size) : m_window_size{ window_size }
+    {
+    }
+
+    auto get_window_size() const -> std::size_t
+    {
+        return m_window_size;
+    }
+
+    /**
+     * Checksum of the window grown by `c` at its end.
+     * @param hash Checksum of the window.
+     * @param c Character to append.
+     * @return Updated checksum.
+     */
+    auto append(Hash hash, char c) const -> Hash
+    {
+        // Every byte already in the window gets one step further from the end, so `b` gains the whole new `a`.
+        const auto a = get_a(hash) + get_char_value(c);
+        const auto b = get_b(hash) + a;
+        return combine(a, b);
+    }
+
+    /**
+     * Checksum of the window without its first character, just after a character was appended to it.
+     * @param hash Checksum of the window, of length `window_size + 1`.
+     * @param first_character Character leaving the window.
+     * @return Updated checksum.
+     */
+    auto remove_first(Hash hash, char first_character) const -> Hash
+    {
+        // With the character just appended, the first one is `m_window_size + 1` steps from the end of the window.
+        const auto char_value = get_char_value(first_character);
+        const auto a = get_a(hash) - char_value;
+        const auto b = get_b(hash) - static_cast<uint32_t>(m_window_size + 1) * char_value;
+        // Unsigned wrap around gives us the arithmetic modulo 2^32 for free.
+        return combine(a, b);
+    }
+
+private:
+    static auto get_a(Hash hash) -> uint32_t
+    {
+        return static_cast<uint32_t>(hash);
+    }
+
+    static auto get_b(Hash hash) -> uint32_t
+    {
+        return static_cast<uint32_t>(hash >> 32);
+    }
+
+    static auto combine(uint32_t a, uint32_t b) -> Hash
+    {
+        return (static_cast<Hash>(b) << 32) | a;
+    }
+
+    static auto get_char_value(char c) -> uint32_t
+    {
+        return static_cast<uint32_t>(static_cast<unsigned char>(c));
+    }
+
+private:
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{};
+};
+
+#endif // ROLLING_CHECKSUM_HPP
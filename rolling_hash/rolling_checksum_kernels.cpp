@@ -0,0 +1,287 @@
+//
+// SIMD kernels for rsync's rolling checksum.
+// Each kernel is compiled for its own instruction set (through `target` attributes), and the one to use is chosen at
+// runtime, so the binary still runs on CPUs without them.
+// Reference for prefix sums in registers: http://0x80.pl/notesen/2018-04-05-sse-prefix-sum.html
+//
+
+#include "rolling_checksum_kernels.hpp"
+
+#include "cpu_dispatch.hpp"
+#include "rolling_checksum.hpp"
+#include "rolling_hash.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ROLLING_CHECKSUM_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace rolling_checksum_kernels
+{
+    namespace
+    {
+        /**
+         * Hashes the windows starting at `first_window` and onwards one at a time, given the checksum of that first
+         * window is already in `output`. Used for whatever the vector loops leave out.
+         */
+        auto hash_remaining_windows(std::string_view input, std::size_t window_size, std::span<uint64_t> output,
+                                    std::size_t first_window) -> void
+        {
+            const auto policy = RollingChecksum(window_size);
+            auto hash = output[first_window];
+            for (auto window = first_window + 1; window < std::size(output); ++window)
+            {
+                hash = policy.remove_first(policy.append(hash, input[window - 1 + window_size]), input[window - 1]);
+                output[window] = hash;
+            }
+        }
+
+        auto hash_all_windows_scalar(std::string_view input, std::size_t window_size, std::span<uint64_t> output)
+            -> void
+        {
+            auto hasher = RollingHash(RollingChecksum(window_size), input, 0);
+            output[0] = hasher.get_current_hash();
+            for (std::size_t window = 1; window < std::size(output); ++window)
+            {
+                hasher.slide_window();
+                output[window] = hasher.get_current_hash();
+            }
+        }
+
+#ifdef ROLLING_CHECKSUM_KERNELS_X86
+        // All the vector kernels follow the same steps. For the N windows after the current one, where byte
+        // `out_k` leaves and byte `in_k` enters the window on the k-th slide:
+        //     a_k = a + (in_0 - out_0) + ... + (in_k - out_k)            (prefix sum of the differences)
+        //     b_k = b + (a_0 - w * out_0) + ... + (a_k - w * out_k)      (prefix sum again)
+        // which is exactly unrolling `RollingChecksum::append` and `remove_first` N times.
+        // Then (a_k, b_k) pairs are interleaved into 64-bit hashes and the last lane seeds the next iteration.
+
+        // Prefix sums of the 32-bit lanes of a register, e.g. (1, 2, 3, 4) -> (1, 3, 6, 10).
+        // Lambdas would not inherit the `target` attribute, hence the separate functions.
+        __attribute__((target("sse4.1"), always_inline)) inline auto prefix_sum_sse41(__m128i x) -> __m128i
+        {
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+            return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        }
+
+        __attribute__((target("avx2"), always_inline)) inline auto prefix_sum_avx2(__m256i x) -> __m256i
+        {
+            // Prefix sums inside each 128-bit half, then carry the total of the low half into the high one
+            x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+            x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+            const auto low_total = _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3));
+            return _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), low_total, 0xF0));
+        }
+
+        __attribute__((target("avx512f"), always_inline)) inline auto prefix_sum_avx512(__m512i x) -> __m512i
+        {
+            // `alignr` with zeros shifts whole lanes up, across the full register
+            const auto zero = _mm512_setzero_si512();
+            x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 15));
+            x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 14));
+            x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 12));
+            return _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 8));
+        }
+
+        __attribute__((target("sse4.1"))) auto hash_all_windows_sse41(std::string_view input, std::size_t window_size,
+                                                                      std::span<uint64_t> output) -> void
+        {
+            constexpr auto lanes = std::size_t{ 4 };
+            const auto* const bytes = reinterpret_cast<const unsigned char*>(std::data(input));
+            const auto slides = std::size(output) - 1;
+            const auto window = _mm_set1_epi32(static_cast<int>(window_size));
+
+            const auto first_hash = RollingHash(RollingChecksum(window_size), input, 0).get_current_hash();
+            output[0] = first_hash;
+            auto a = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(first_hash)));
+            auto b = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(first_hash >> 32)));
+
+            auto slide = std::size_t{ 0 };
+            for (; slide + lanes <= slides; slide += lanes)
+            {
+                int32_t outgoing_bytes{};
+                int32_t incoming_bytes{};
+                std::memcpy(&outgoing_bytes, bytes + slide, sizeof(outgoing_bytes));
+                std::memcpy(&incoming_bytes, bytes + slide + window_size, sizeof(incoming_bytes));
+                const auto outgoing = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(outgoing_bytes));
+                const auto incoming = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(incoming_bytes));
+
+                const auto new_a = _mm_add_epi32(a, prefix_sum_sse41(_mm_sub_epi32(incoming, outgoing)));
+                const auto b_steps = _mm_sub_epi32(new_a, _mm_mullo_epi32(window, outgoing));
+                const auto new_b = _mm_add_epi32(b, prefix_sum_sse41(b_steps));
+
+                auto* const destination = reinterpret_cast<__m128i*>(std::data(output) + slide + 1);
+                _mm_storeu_si128(destination, _mm_unpacklo_epi32(new_a, new_b));
+                _mm_storeu_si128(destination + 1, _mm_unpackhi_epi32(new_a, new_b));
+
+                a = _mm_shuffle_epi32(new_a, 0xFF);
+                b = _mm_shuffle_epi32(new_b, 0xFF);
+            }
+            hash_remaining_windows(input, window_size, output, slide);
+        }
+
+        __attribute__((target("avx2"))) auto hash_all_windows_avx2(std::string_view input, std::size_t window_size,
+                                                                   std::span<uint64_t> output) -> void
+        {
+            constexpr auto lanes = std::size_t{ 8 };
+            const auto* const bytes = reinterpret_cast<const unsigned char*>(std::data(input));
+            const auto slides = std::size(output) - 1;
+            const auto window = _mm256_set1_epi32(static_cast<int>(window_size));
+            const auto last_lane = _mm256_set1_epi32(7);
+
+            const auto first_hash = RollingHash(RollingChecksum(window_size), input, 0).get_current_hash();
+            output[0] = first_hash;
+            auto a = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(first_hash)));
+            auto b = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(first_hash >> 32)));
+
+            auto slide = std::size_t{ 0 };
+            for (; slide + lanes <= slides; slide += lanes)
+            {
+                const auto outgoing = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + slide)));
+                const auto incoming = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + slide + window_size)));
+
+                const auto new_a = _mm256_add_epi32(a, prefix_sum_avx2(_mm256_sub_epi32(incoming, outgoing)));
+                const auto b_steps = _mm256_sub_epi32(new_a, _mm256_mullo_epi32(window, outgoing));
+                const auto new_b = _mm256_add_epi32(b, prefix_sum_avx2(b_steps));
+
+                // Interleaving works inside 128-bit halves, so the halves need to be put back in order
+                const auto low = _mm256_unpacklo_epi32(new_a, new_b);
+                const auto high = _mm256_unpackhi_epi32(new_a, new_b);
+                auto* const destination = reinterpret_cast<__m256i*>(std::data(output) + slide + 1);
+                _mm256_storeu_si256(destination, _mm256_permute2x128_si256(low, high, 0x20));
+                _mm256_storeu_si256(destination + 1, _mm256_permute2x128_si256(low, high, 0x31));
+
+                a = _mm256_permutevar8x32_epi32(new_a, last_lane);
+                b = _mm256_permutevar8x32_epi32(new_b, last_lane);
+            }
+            hash_remaining_windows(input, window_size, output, slide);
+        }
+
+        __attribute__((target("avx512f"))) auto hash_all_windows_avx512(std::string_view input,
+                                                                        std::size_t window_size,
+                                                                        std::span<uint64_t> output) -> void
+        {
+            constexpr auto lanes = std::size_t{ 16 };
+            const auto* const bytes = reinterpret_cast<const unsigned char*>(std::data(input));
+            const auto slides = std::size(output) - 1;
+            const auto window = _mm512_set1_epi32(static_cast<int>(window_size));
+            const auto last_lane = _mm512_set1_epi32(15);
+            // Which lanes of (a, b) go into the first and second halves of the output, interleaved
+            const auto first_half = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+            const auto second_half = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+            const auto first_hash = RollingHash(RollingChecksum(window_size), input, 0).get_current_hash();
+            output[0] = first_hash;
+            auto a = _mm512_set1_epi32(static_cast<int>(static_cast<uint32_t>(first_hash)));
+            auto b = _mm512_set1_epi32(static_cast<int>(static_cast<uint32_t>(first_hash >> 32)));
+
+            auto slide = std::size_t{ 0 };
+            for (; slide + lanes <= slides; slide += lanes)
+            {
+                const auto outgoing = _mm512_cvtepu8_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + slide)));
+                const auto incoming = _mm512_cvtepu8_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + slide + window_size)));
+
+                const auto new_a = _mm512_add_epi32(a, prefix_sum_avx512(_mm512_sub_epi32(incoming, outgoing)));
+                const auto b_steps = _mm512_sub_epi32(new_a, _mm512_mullo_epi32(window, outgoing));
+                const auto new_b = _mm512_add_epi32(b, prefix_sum_avx512(b_steps));
+
+                auto* const destination = std::data(output) + slide + 1;
+                _mm512_storeu_si512(destination, _mm512_permutex2var_epi32(new_a, first_half, new_b));
+                _mm512_storeu_si512(destination + lanes / 2, _mm512_permutex2var_epi32(new_a, second_half, new_b));
+
+                a = _mm512_permutexvar_epi32(last_lane, new_a);
+                b = _mm512_permutexvar_epi32(last_lane, new_b);
+            }
+            hash_remaining_windows(input, window_size, output, slide);
+        }
+#endif
+
+        /**
+         * Level of the central dispatch that enables `kernel`, see `cpu_dispatch::IsaLevel`.
+         */
+        auto get_isa_level(const Kernel kernel) -> cpu_dispatch::IsaLevel
+        {
+            switch (kernel)
+            {
+            case Kernel::scalar:
+                return cpu_dispatch::IsaLevel::baseline;
+            case Kernel::sse41:
+                return cpu_dispatch::IsaLevel::x86_64_v2;
+            case Kernel::avx2:
+                return cpu_dispatch::IsaLevel::x86_64_v3;
+            case Kernel::avx512:
+                return cpu_dispatch::IsaLevel::x86_64_v4;
+            }
+            throw std::runtime_error("Unknown rolling checksum kernel.");
+        }
+    } // namespace
+
+    auto is_supported(const Kernel kernel) -> bool
+    {
+        switch (kernel)
+        {
+        case Kernel::scalar:
+            return true;
+#ifdef ROLLING_CHECKSUM_KERNELS_X86
+        case Kernel::sse41:
+            return __builtin_cpu_supports("sse4.1");
+        case Kernel::avx2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::avx512:
+            return __builtin_cpu_supports("avx512f");
+#else
+        default:
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    auto best_supported_kernel() -> Kernel
+    {
+        static const auto best = []
+        {
+            for (const auto kernel : { Kernel::avx512, Kernel::avx2, Kernel::sse41 })
+            {
+                if (is_supported(kernel) && cpu_dispatch::is_enabled(get_isa_level(kernel)))
+                    return kernel;
+            }
+            return Kernel::scalar;
+        }();
+        return best;
+    }
+
+    auto hash_all_windows(std::string_view input, std::size_t window_size, std::span<uint64_t> output,
+                          const Kernel kernel) -> void
+    {
+        assert(window_size >= 1 && window_size <= std::size(input));
+        assert(std::size(output) == std::size(input) - window_size + 1);
+        if (!is_supported(kernel))
+            throw std::runtime_error("This CPU does not support the requested rolling checksum kernel.");
+
+        switch (kernel)
+        {
+        case Kernel::scalar:
+            return hash_all_windows_scalar(input, window_size, output);
+#ifdef ROLLING_CHECKSUM_KERNELS_X86
+        case Kernel::sse41:
+            return hash_all_windows_sse41(input, window_size, output);
+        case Kernel::avx2:
+            return hash_all_windows_avx2(input, window_size, output);
+        case Kernel::avx512:
+            return hash_all_windows_avx512(input, window_size, output);
+#else
+        default:
+            break;
+#endif
+        }
+    }
+} // namespace rolling_checksum_kernels
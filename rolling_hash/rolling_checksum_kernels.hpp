@@ -0,0 +1,58 @@
+//
+// SIMD kernels computing rsync's rolling checksum (see `RollingChecksum`) for every window of an input.
+//
+
+#ifndef ROLLING_CHECKSUM_KERNELS_HPP
+#define ROLLING_CHECKSUM_KERNELS_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace rolling_checksum_kernels
+{
+    // Instruction sets with a kernel, from the most portable to the fastest.
+    enum class Kernel
+    {
+        // Plain `RollingHash<RollingChecksum>`, one window at a time
+        scalar,
+        // 4 windows per iteration
+        sse41,
+        // 8 windows per iteration
+        avx2,
+        // 16 windows per iteration
+        avx512,
+    };
+
+    /**
+     * Whether the CPU we are running on supports `kernel`.
+     * @param kernel Kernel to check.
+     * @return True if `kernel` can be used.
+     */
+    auto is_supported(Kernel kernel) -> bool;
+
+    /**
+     * Fastest kernel the CPU we are running on supports, and the active ISA level allows (see
+     * `cpu_dispatch::get_active_isa_level`). Detected once.
+     * @return Kernel to use.
+     */
+    auto best_supported_kernel() -> Kernel;
+
+    /**
+     * Computes the rolling checksum of every window of `window_size` in `input`, as `RollingChecksum` would.
+     * \n
+     * Instead of waiting on the previous window for each new one, the kernels compute several consecutive windows
+     * per iteration: the differences between incoming and outgoing bytes are prefix-summed inside a vector register,
+     * giving the `a` sums of all those windows at once, and the same is done for `b`.
+     * REQUIREMENTS: `window_size` is between 1 and the length of `input`, `output` has room for exactly
+     * `size(input) - window_size + 1` hashes, and `kernel` is supported.
+     * @param input Input to hash.
+     * @param window_size Size of each window.
+     * @param output Where to write the checksum of each window, in order.
+     * @param kernel Kernel to use.
+     */
+    auto hash_all_windows(std::string_view input, std::size_t window_size, std::span<uint64_t> output,
+                          Kernel kernel = best_supported_kernel()) -> void;
+} // namespace rolling_checksum_kernels
+
+#endif // ROLLING_CHECKSUM_KERNELS_HPP
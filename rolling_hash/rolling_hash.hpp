@@ -5,82 +5,265 @@
 #ifndef ROLLING_HASH_HPP
 #define ROLLING_HASH_HPP
 
+#include <cassert>
+#include <concepts>
 #include <cstdint>
-#include <deque>
+#include <span>
+#include <stdexcept>
 #include <string_view>
-#include <vector>
+#include <utility>
 
+#include "polynomial_hash.hpp"
+#include "sliding_window.hpp"
+
+/**
+ * What a hash needs to provide to be used by `RollingHash`.
+ * \n
+ * A policy is built for a fixed window size, and only knows how to update a hash value: `append` gives the hash of
+ * the window grown by one character at its end, and `remove_first` then gives the hash of the window without its
+ * first character. The hash of the empty window is `Hash{}`. `append` does not depend on the window size, so any
+ * string, even a shorter one, can be hashed by appending its characters.
+ * Both are called for every byte, so they should be defined in the policy's header to be inlined.
+ * A policy may also provide `hash_window(window)`, computing the hash of a whole window faster than appending its
+ * characters one by one.
+ */
+template <typename Policy>
+concept RollingHashPolicy = requires(const Policy& policy, typename Policy::Hash hash, char c) {
+    {
+        policy.get_window_size()
+    } -> std::convertible_to<std::size_t>;
+    {
+        policy.append(hash, c)
+    } -> std::same_as<typename Policy::Hash>;
+    {
+        policy.remove_first(hash, c)
+    } -> std::same_as<typename Policy::Hash>;
+};
+
+/**
+ * Computes the hash of `window` from scratch, as if appending each of its characters to the empty window.
+ * \n
+ * Nothing is copied nor allocated, so a single policy can hash any number of windows.
+ * @param policy How to compute the hash.
+ * @param window Characters to hash. May be shorter than the policy's window size.
+ * @return Hash of `window`.
+ */
+template <RollingHashPolicy Policy>
+auto compute_window_hash(const Policy& policy, std::string_view window) -> typename Policy::Hash
+{
+    if constexpr (requires { policy.hash_window(window); })
+    {
+        if (std::size(window) == policy.get_window_size())
+            return policy.hash_window(window);
+    }
+    auto hash = typename Policy::Hash{};
+    for (auto c : window)
+        hash = policy.append(hash, c);
+    return hash;
+}
+
+/**
+ * Hash of a fixed-size window sliding through an input, updated in constant time for each slide.
+ * \n
+ * How the hash is computed is up to `Policy` (see `RollingHashPolicy`). Everything is resolved at compile time, so
+ * the loops sliding the window are fully inlined for each policy, with no virtual call nor branch on the kind of
+ * hash.
+ */
+template <RollingHashPolicy Policy = PolynomialHash>
 class RollingHash
 {
 public:
-    using Hash = uint64_t;
+    using Hash = typename Policy::Hash;
 
 public:
     /**
      * Initializes the structure with `initial_input` string (and hash).
-     * REQUIREMENTS: `initial_input` should be of length `window_size`.
+     * \n
+     * The structure keeps its own copy of the window, so it can be fed byte by byte through `slide_window(c)`.
+     * REQUIREMENTS: `initial_input` should be of length `policy.get_window_size()`.
+     * @param policy How to compute the hash.
+     * @param initial_input Initial window.
+     */
+    RollingHash(Policy policy, std::string_view initial_input)
+        : m_policy{ std::move(policy) }, m_window{ m_policy.get_window_size(), initial_input }
+    {
+        initialize();
+    }
+
+    /**
+     * Initializes the structure with the window of `input` starting at `window_start`.
+     * \n
+     * No copy is made: the structure only views `input`, reading the incoming and outgoing bytes by offset
+     * when sliding with `slide_window()`. `input` must outlive the structure.
+     * REQUIREMENTS: `window_start + policy.get_window_size()` should not be bigger than the length of `input`.
+     * @param policy How to compute the hash.
+     * @param input Whole input the window will slide through.
+     * @param window_start Offset of the first window in `input`.
+     */
+    RollingHash(Policy policy, std::string_view input, std::size_t window_start)
+        : m_policy{ std::move(policy) }, m_window{ m_policy.get_window_size(), input, window_start }
+    {
+        initialize();
+    }
+
+    /**
+     * Polynomial hash with the given parameters, see `PolynomialHash` and the first constructor.
      * @param alphabet_base Base to use for hashing computations. Should be bigger than the alphabet.
      * @param modulo Modulo to use for hashing. Should be prime.
      * @param window_size Size of the window for the structure to slide.
      * @param initial_input Initial window.
      */
-    RollingHash(uint64_t alphabet_base, uint64_t modulo, uint64_t window_size, std::string_view initial_input);
+    RollingHash(uint64_t alphabet_base, uint64_t modulo, uint64_t window_size, std::string_view initial_input)
+        requires std::same_as<Policy, PolynomialHash>
+        : RollingHash(PolynomialHash(alphabet_base, modulo, window_size), initial_input)
+    {
+    }
+
+    /**
+     * Polynomial hash with the given parameters, see `PolynomialHash` and the second constructor.
+     * @param alphabet_base Base to use for hashing computations. Should be bigger than the alphabet.
+     * @param modulo Modulo to use for hashing. Should be prime.
+     * @param window_size Size of the window for the structure to slide.
+     * @param input Whole input the window will slide through.
+     * @param window_start Offset of the first window in `input`.
+     */
+    RollingHash(uint64_t alphabet_base, uint64_t modulo, uint64_t window_size, std::string_view input,
+                std::size_t window_start)
+        requires std::same_as<Policy, PolynomialHash>
+        : RollingHash(PolynomialHash(alphabet_base, modulo, window_size), input, window_start)
+    {
+    }
 
     /**
      * Get current hash from string in structure.
      * @return Current hash value.
      */
-    auto get_current_hash() const -> Hash;
+    auto get_current_hash() const -> Hash
+    {
+        return m_current_hash;
+    }
 
     /**
      * Updates the structure to have the hash of the next "sliding window".
      * `c` is appended and the first one is removed. This maintains the invariant that
      * the underlying string is always of the same size (thus a fixed "window" which just "slides" through the input).
+     * REQUIREMENTS: structure built with the first constructor.
      * @param c Character to add to the structure.
      */
-    auto slide_window(char c) -> void;
+    auto slide_window(char c) -> void
+    {
+        const auto first_character = m_window.replace_first(c);
+        m_current_hash = m_policy.remove_first(m_policy.append(m_current_hash, c), first_character);
+    }
 
-private:
-    // As this is only used for the rolling hash in file diff,
-    // we do not expose `append` nor `remove_first` operations to maintain the fixed window size.
-    // In a more general application, we could make those functions public and add some more.
+    /**
+     * Updates the structure to have the hash of the next window of the viewed input.
+     * Only the hash is updated: both bytes involved are read straight from the input.
+     * REQUIREMENTS: structure built over an input (with `window_start`), and `can_slide()`.
+     */
+    auto slide_window() -> void
+    {
+        const auto incoming = m_window.get_incoming();
+        const auto outgoing = m_window.get_outgoing();
+        m_current_hash = m_policy.remove_first(m_policy.append(m_current_hash, incoming), outgoing);
+        m_window.advance();
+    }
+
+    /**
+     * Slides the window once for each byte of `incoming`, writing the hash after each slide into `output`.
+     * \n
+     * Same as calling `slide_window(c)` and `get_current_hash()` for each byte, in a single tight loop.
+     * REQUIREMENTS: structure built with the first constructor, and `output` at least as long as `incoming`.
+     * @param incoming Characters to add to the structure, in order.
+     * @param output Where to write the hash of each window.
+     */
+    auto slide_many(std::string_view incoming, std::span<Hash> output) -> void
+    {
+        assert(std::size(output) >= std::size(incoming));
+        auto hash = m_current_hash;
+        for (std::size_t i = 0; i < std::size(incoming); ++i)
+        {
+            const auto first_character = m_window.replace_first(incoming[i]);
+            hash = m_policy.remove_first(m_policy.append(hash, incoming[i]), first_character);
+            output[i] = hash;
+        }
+        m_current_hash = hash;
+    }
 
     /**
-     * Appends a char to the structure.
-     * After this operation, `m_current_hash` and `m_current_string` are updated.
-     * @param c Character to add to structure.
+     * Slides the window through the viewed input once for each element of `output`, writing the hash after each
+     * slide into it.
+     * \n
+     * Same as calling `slide_window()` and `get_current_hash()` `std::size(output)` times, in a single tight loop
+     * over the input with no bounds checks, which the compiler is free to unroll.
+     * REQUIREMENTS: structure built over an input (with `window_start`).
+     * Throws if there are less than `std::size(output)` windows left in the input.
+     * @param output Where to write the hash of each window.
      */
-    auto append(char c) -> void;
+    auto slide_many(std::span<Hash> output) -> void
+    {
+        if (std::size(output) > m_window.get_slides_left())
+            throw std::runtime_error("Not enough windows left in the input.");
+        const auto incoming = m_window.get_incoming(std::size(output));
+        const auto outgoing = m_window.get_outgoing(std::size(output));
+        auto hash = m_current_hash;
+        for (std::size_t i = 0; i < std::size(output); ++i)
+        {
+            hash = m_policy.remove_first(m_policy.append(hash, incoming[i]), outgoing[i]);
+            output[i] = hash;
+        }
+        m_current_hash = hash;
+        m_window.advance(std::size(output));
+    }
 
     /**
-     * Removes the first character (leftmost) from the structure.
-     * After this operation, `m_current_hash` and `m_current_string` are updated.
+     * Moves the window to start at `window_start` in the viewed input, anywhere before or after the current one.
+     * \n
+     * The hash is computed from scratch for the new window, which costs about as much as `window_size` appends.
+     * Nothing is allocated, so matchers can skip the windows they do not need instead of sliding through them.
+     * REQUIREMENTS: structure built over an input (with `window_start`), and the new window fits inside it.
+     * @param window_start Offset of the new window in the viewed input.
      */
-    auto remove_first() -> void;
+    auto reset_at(std::size_t window_start) -> void
+    {
+        m_window.jump_to(window_start);
+        m_current_hash = compute_window_hash(m_policy, m_window.get_current_window());
+    }
 
     /**
-     * Get ascii value from a character.
-     * @param c Character to get value from.
-     * @return Ascii value as unsigned.
+     * Whether there is a next window in the viewed input.
+     * @return True if `slide_window()` may be called.
+     */
+    auto can_slide() const -> bool
+    {
+        return m_window.can_slide();
+    }
+
+    /**
+     * Offset of the current window in the viewed input.
+     * @return Index of the first byte of the current window.
+     */
+    auto get_window_start() const -> std::size_t
+    {
+        return m_window.get_window_start();
+    }
+
+private:
+    /**
+     * Computes the hash of the first window from scratch.
      */
-    static auto get_ascii_value_from_char(char c) -> uint64_t;
+    auto initialize() -> void
+    {
+        m_current_hash = compute_window_hash(m_policy, m_window.get_first_window());
+    }
 
 private:
-    // Hash for the current underlying string in the structure.
+    // Hash for the current window.
     Hash m_current_hash{};
-    // Maintain the underlying string. Efficient operations from `push_back` and `push_front`.
-    std::deque<char> m_current_string{};
-    // Base for hashing. 257 is good for ASCII values, as we are using in file diff.
-    const uint64_t m_alphabet_base{ 257 };
-    // Mod for hashing. 1e9 + 7 is a prime which is not too big (we have room for operations as we use 64 bits), but
-    // big enough so we do not expect many collisions.
-    const uint64_t m_modulo{ static_cast<uint64_t>(1e9 + 7) };
-    // Fixed window size throughout the structure.
-    const std::size_t m_window_size{ 3 };
-    // For efficiency purposes, we precompute all the base powers we may need to use.
-    // Otherwise, we would need to pay some performance price everytime to calculate those.
-    // It's possible to precompute because we know the fixed window size.
-    std::vector<uint64_t> m_precomputed_base_powers{};
+    // How the hash is computed.
+    Policy m_policy;
+    // Which characters enter and leave the window, either from the viewed input or from our own copy.
+    SlidingWindow m_window;
 };
 
 #endif // ROLLING_HASH_HPP
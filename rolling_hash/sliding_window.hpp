@@ -0,0 +1,187 @@
+//
+// Window bookkeeping shared by the rolling hashes.
+//
+
+#ifndef SLIDING_WINDOW_HPP
+#define SLIDING_WINDOW_HPP
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * Keeps track of which bytes enter and leave a fixed-size window, for the rolling hashes.
+ * \n
+ * The window either views the whole input (and then reads bytes from it by offset, without copying anything),
+ * or keeps its own copy of the window in a circular buffer when the caller feeds it byte by byte.
+ * Member functions are defined here so that they are inlined in the hashes' sliding loops.
+ */
+class SlidingWindow
+{
+public:
+    /**
+     * Keeps a copy of `initial_input` as the window.
+     * REQUIREMENTS: `initial_input` should be of length `window_size`.
+     * @param window_size Size of the window.
+     * @param initial_input Initial window.
+     */
+    SlidingWindow(std::size_t window_size, std::string_view initial_input)
+        : m_window_size{ window_size }, m_owned_window{ initial_input }
+    {
+        // At all times, we must keep the invariant that the current string is of length window_size
+        // specifically, here we need to check that the initial input is valid.
+        if (std::size(initial_input) != m_window_size)
+            throw std::runtime_error("initial_input must be of length window_size.");
+    }
+
+    /**
+     * Views `input`, with the window starting at `window_start`. `input` must outlive the structure.
+     * REQUIREMENTS: `window_start + window_size` should not be bigger than the length of `input`.
+     * @param window_size Size of the window.
+     * @param input Whole input the window will slide through.
+     * @param window_start Offset of the first window in `input`.
+     */
+    SlidingWindow(std::size_t window_size, std::string_view input, std::size_t window_start)
+        : m_window_size{ window_size }, m_input{ input }, m_window_start{ window_start }
+    {
+        // The whole first window must be inside the input.
+        if (window_start > std::size(input) || std::size(input) - window_start < m_window_size)
+            throw std::runtime_error("The window must fit inside input.");
+    }
+
+    /**
+     * Bytes of the window the structure was built with.
+     * @return View of the first window (owned or from the input).
+     */
+    auto get_first_window() const -> std::string_view
+    {
+        if (m_owned_window.empty())
+            return m_input.substr(m_window_start, m_window_size);
+        return m_owned_window;
+    }
+
+    /**
+     * Owned window only: `c` enters the window and the leftmost byte leaves it.
+     * @param c Byte entering the window.
+     * @return Byte leaving the window.
+     */
+    auto replace_first(char c) -> char
+    {
+        assert(!m_owned_window.empty());
+        // The new character takes the place of the one leaving, and the window now starts right after it
+        const auto first_character = m_owned_window[m_owned_window_head];
+        m_owned_window[m_owned_window_head] = c;
+        m_owned_window_head += 1;
+        if (m_owned_window_head == m_window_size)
+            m_owned_window_head = 0;
+        return first_character;
+    }
+
+    /**
+     * Viewed input only: byte entering the window on the next slide.
+     * REQUIREMENTS: `can_slide()`.
+     */
+    auto get_incoming() const -> char
+    {
+        assert(can_slide());
+        return m_input[m_window_start + m_window_size];
+    }
+
+    /**
+     * Viewed input only: byte leaving the window on the next slide.
+     */
+    auto get_outgoing() const -> char
+    {
+        return m_input[m_window_start];
+    }
+
+    /**
+     * Viewed input only: the next `count` bytes entering the window, one per slide.
+     * REQUIREMENTS: `count` is at most `get_slides_left()`.
+     */
+    auto get_incoming(std::size_t count) const -> std::string_view
+    {
+        assert(count <= get_slides_left());
+        return m_input.substr(m_window_start + m_window_size, count);
+    }
+
+    /**
+     * Viewed input only: the next `count` bytes leaving the window, one per slide.
+     * REQUIREMENTS: `count` is at most `get_slides_left()`.
+     */
+    auto get_outgoing(std::size_t count) const -> std::string_view
+    {
+        assert(count <= get_slides_left());
+        return m_input.substr(m_window_start, count);
+    }
+
+    /**
+     * Viewed input only: moves the window `count` bytes to the right.
+     */
+    auto advance(std::size_t count = 1) -> void
+    {
+        m_window_start += count;
+    }
+
+    /**
+     * Viewed input only: how many times the window can still move one byte to the right.
+     */
+    auto get_slides_left() const -> std::size_t
+    {
+        return std::size(m_input) - m_window_start - m_window_size;
+    }
+
+    /**
+     * Viewed input only: moves the window to start at `window_start`, anywhere in the input.
+     * REQUIREMENTS: `window_start + window_size` should not be bigger than the length of `input`.
+     * @param window_start New offset of the window in the input.
+     */
+    auto jump_to(std::size_t window_start) -> void
+    {
+        if (window_start > std::size(m_input) || std::size(m_input) - window_start < m_window_size)
+            throw std::runtime_error("The window must fit inside input.");
+        m_window_start = window_start;
+    }
+
+    /**
+     * Viewed input only: bytes of the current window.
+     * @return View of the current window in the input.
+     */
+    auto get_current_window() const -> std::string_view
+    {
+        return m_input.substr(m_window_start, m_window_size);
+    }
+
+    /**
+     * Whether there is a next window in the viewed input.
+     * @return True if the window may `advance()`.
+     */
+    auto can_slide() const -> bool
+    {
+        return m_window_start + m_window_size < std::size(m_input);
+    }
+
+    /**
+     * Offset of the current window in the viewed input.
+     * @return Index of the first byte of the current window.
+     */
+    auto get_window_start() const -> std::size_t
+    {
+        return m_window_start;
+    }
+
+private:
+    // Fixed window size throughout the structure.
+    std::size_t m_window_size{};
+    // Input the window slides through, when built over one. We only read from it.
+    std::string_view m_input{};
+    // Offset of the current window in `m_input`.
+    std::size_t m_window_start{};
+    // Otherwise, we keep our own copy of the window as a circular buffer, so that we know which character
+    // leaves the window. `m_owned_window_head` is the position of the leftmost one.
+    std::string m_owned_window{};
+    std::size_t m_owned_window_head{};
+};
+
+#endif // SLIDING_WINDOW_HPP
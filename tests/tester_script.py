@@ -78,6 +78,26 @@ for test_number in range(1, number_tests + 1):
         algorithm_better_counter += 1
     print(f"#{processed_counter}/{number_tests}")
 
+# Line-aware chunks of a text file longer than the 8 MiB buffer of the streamed signature. Lines longer than the
+# maximum chunk size (256 bytes for 64-byte chunks) are cut every 256 bytes, which puts a chunk boundary exactly 256
+# bytes before the end of the first buffer. The line break 16 bytes later ends that chunk, which is only seen with
+# the bytes after the buffer.
+long_line_size = 8 * 2 ** 20 - 256 + 16
+lines = [f"line {i * 7919 % 10007} of a text file\n" for i in range(50_000)]
+long_lines = "x" * long_line_size + "\n" + "x" * 300 + "\n"
+with open("long_file1", "w") as long_file1:
+    long_file1.write(long_lines + "".join(lines))
+lines.insert(30_000, "an inserted line\n")
+with open("long_file2", "w") as long_file2:
+    long_file2.write(long_lines + "".join(lines))
+subprocess.run(["../build/rolling_hash_file_diff", "signature", "long_file1", "signature_file", "--chunking", "lines",
+                "--chunk-size", "64"])
+subprocess.run(["../build/rolling_hash_file_diff", "delta", "signature_file", "long_file2", "delta_file"])
+subprocess.run(["../build/rolling_hash_file_diff", "patch", "long_file1", "delta_file", "reconstructed_file"])
+if not filecmp.cmp("long_file2", "reconstructed_file", shallow=False):
+    print("Something wrong with the line-aware chunks of a long file")
+    bad_counter += 1
+
 print(f"Finished testing the algorithm for {number_tests} test cases in {tests_directory}");
 print("Algorithm failures: ", bad_counter)
 print(f"Total size for simply sending: {send_file_total_size}")
@@ -90,3 +110,5 @@ print(f"Algorithm better in {algorithm_better_counter}/{number_tests} cases")
 os.remove('signature_file')
 os.remove('delta_file')
 os.remove('reconstructed_file')
+os.remove('long_file1')
+os.remove('long_file2')
@@ -1,6 +1,48 @@
 #include "catch.hpp"
 
+#include <filesystem>
+#include <sstream>
+
 #include "../file_diff/file_diff.hpp"
+#include "../io_helpers/io_helpers.hpp"
+#include "../rolling_hash/buzhash.hpp"
+#include "../rolling_hash/cpu_dispatch.hpp"
+#include "../rolling_hash/crc32c_hash.hpp"
+#include "../rolling_hash/double_polynomial_hash.hpp"
+#include "../rolling_hash/fastcdc.hpp"
+#include "../rolling_hash/fixed_window_polynomial_hash.hpp"
+#include "../rolling_hash/interleaved_rolling_hash.hpp"
+#include "../rolling_hash/line_chunking.hpp"
+#include "../rolling_hash/rabin_fingerprint.hpp"
+#include "../rolling_hash/rolling_checksum.hpp"
+#include "../rolling_hash/rolling_checksum_kernels.hpp"
+#include "../rolling_hash/rolling_hash.hpp"
+
+namespace
+{
+    /**
+     * 300 bytes going through the whole range of byte values, for checking rolling hashes against their definition.
+     */
+    auto make_whole_range_string() -> std::string
+    {
+        auto result = std::string{};
+        for (auto i = 0; i < 300; ++i)
+            result.push_back(static_cast<char>(i * 37));
+        return result;
+    }
+
+    /**
+     * `size` bytes without any obvious repetition, e.g. long enough to be split across several threads.
+     */
+    auto make_long_string(std::size_t size) -> std::string
+    {
+        auto result = std::string{};
+        result.reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+            result.push_back(static_cast<char>((i * 7919) ^ (i >> 5)));
+        return result;
+    }
+} // namespace
 
 TEST_CASE("Strings are split into chunks")
 {
@@ -85,6 +127,21 @@ TEST_CASE("Strings are split into chunks")
                 REQUIRE(split_string.at(7) == "ht");
             }
         }
+        WHEN("We view the chunks instead of copying them")
+        {
+            const auto chunk_size = std::size_t{ 5 };
+            const auto chunk_views = FileDiff::get_chunk_views(original_string, chunk_size);
+            THEN("They are the same chunks, pointing into the original string")
+            {
+                const auto split_string = FileDiff::split_into_chunks(original_string, chunk_size);
+                REQUIRE(std::size(chunk_views) == std::size(split_string));
+                for (std::size_t i = 0; i < std::size(chunk_views); ++i)
+                {
+                    REQUIRE(chunk_views[i] == split_string[i]);
+                    REQUIRE(std::data(chunk_views[i]) == std::data(original_string) + i * chunk_size);
+                }
+            }
+        }
     }
 }
 
@@ -187,7 +244,7 @@ TEST_CASE("Delta for equal strings is all references to chunks")
     }
 }
 
-TEST_CASE("Delta for equal strings is all references to chunks minus possibly the last chunk")
+TEST_CASE("Delta for equal strings is all references to chunks, including a short last chunk")
 {
     GIVEN("Two equal strings")
     {
@@ -200,13 +257,20 @@ TEST_CASE("Delta for equal strings is all references to chunks minus possibly th
         {
             const auto left_signature = FileDiff::compute_signature(left_string, chunk_size);
             const auto right_delta = FileDiff::compute_delta(right_string, left_signature, chunk_size);
-            THEN("Delta is all references to chunks")
+            THEN("Delta is all references to chunks, the last one matched by its length at the end")
+            {
+                REQUIRE(left_signature.tail_length == 2);
+                REQUIRE(right_delta == "@0@1@2");
+                REQUIRE(FileDiff::apply_delta(left_string, right_delta, chunk_size) == right_string);
+            }
+        }
+        WHEN("The short last chunk is somewhere else than at the end")
+        {
+            const auto left_signature = FileDiff::compute_signature(left_string, chunk_size);
+            const auto right_delta = FileDiff::compute_delta("GHABCDEF"s, left_signature, chunk_size);
+            THEN("It does not match")
             {
-                // As we are computing the rolling hashes of only chunks of `chunk_size`
-                // The last one will not match
-                REQUIRE(right_delta == "@0@1bGbH");
-                // This is not a big problem because it may happen only with the last chunk
-                // which should be a small portion of a big file
+                REQUIRE(right_delta == "bGbH@0@1");
             }
         }
     }
@@ -297,3 +361,1187 @@ TEST_CASE("Reconstruct file from mix of literal bytes and reference to chunks de
         }
     }
 }
+
+TEST_CASE("Rolling hash over an input view matches the hash over its own window")
+{
+    GIVEN("A string and a window size")
+    {
+        const auto input = std::string{ "Whatever our souls are made of, his and mine are the same." };
+        const auto window_size = std::size_t{ 7 };
+        const auto base = uint64_t{ 257 };
+        const auto modulo = static_cast<uint64_t>(1e9 + 7);
+        WHEN("We slide both structures through the whole string")
+        {
+            auto owned = RollingHash(base, modulo, window_size, std::string_view{ input }.substr(0, window_size));
+            auto viewed = RollingHash(base, modulo, window_size, input, 0);
+            THEN("Every window has the same hash as if computed from scratch")
+            {
+                for (std::size_t start = 0;; ++start)
+                {
+                    const auto window = std::string_view{ input }.substr(start, window_size);
+                    const auto from_scratch = RollingHash(base, modulo, window_size, window).get_current_hash();
+                    REQUIRE(viewed.get_window_start() == start);
+                    REQUIRE(owned.get_current_hash() == from_scratch);
+                    REQUIRE(viewed.get_current_hash() == from_scratch);
+                    if (!viewed.can_slide())
+                        break;
+                    owned.slide_window(input.at(start + window_size));
+                    viewed.slide_window();
+                }
+                REQUIRE(viewed.get_window_start() == std::size(input) - window_size);
+            }
+        }
+        WHEN("The first window does not fit in the input")
+        {
+            THEN("The structure can not be built")
+            {
+                REQUIRE_THROWS(RollingHash(base, modulo, window_size, input, std::size(input) - window_size + 1));
+            }
+        }
+    }
+}
+
+TEST_CASE("Rolling hash moved to another window")
+{
+    GIVEN("A rolling hash over a string")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        auto hasher = RollingHash(Buzhash(window_size), input, 0);
+        auto hash_at = [&](std::size_t window_start)
+        { return RollingHash(Buzhash(window_size), input, window_start).get_current_hash(); };
+        WHEN("We move it forwards and backwards")
+        {
+            THEN("It has the hash of the new window, and keeps sliding from there")
+            {
+                for (const auto window_start : { std::size_t{ 100 }, std::size_t{ 3 }, std::size_t{ 284 } })
+                {
+                    hasher.reset_at(window_start);
+                    REQUIRE(hasher.get_window_start() == window_start);
+                    REQUIRE(hasher.get_current_hash() == hash_at(window_start));
+                }
+                hasher.reset_at(50);
+                hasher.slide_window();
+                REQUIRE(hasher.get_current_hash() == hash_at(51));
+            }
+        }
+        WHEN("We move it past the end of the string")
+        {
+            THEN("It fails")
+            {
+                REQUIRE_THROWS(hasher.reset_at(285));
+            }
+        }
+    }
+}
+
+TEST_CASE("Rolling hash slid many times at once")
+{
+    GIVEN("A string with bytes from the whole range and a window size")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        const auto policy = PolynomialHash(257, PolynomialHash::mersenne_modulo, window_size);
+
+        auto expected = std::vector<uint64_t>{};
+        auto reference = RollingHash(policy, input, 0);
+        while (reference.can_slide())
+        {
+            reference.slide_window();
+            expected.push_back(reference.get_current_hash());
+        }
+
+        WHEN("We slide through the viewed string in a few batches")
+        {
+            auto hasher = RollingHash(policy, input, 0);
+            auto output = std::vector<uint64_t>(std::size(expected));
+            hasher.slide_many(std::span{ output }.first(100));
+            hasher.slide_many(std::span{ output }.subspan(100, 0));
+            hasher.slide_many(std::span{ output }.subspan(100));
+            THEN("We get the same hashes as sliding one byte at a time")
+            {
+                REQUIRE(output == expected);
+                REQUIRE(hasher.get_current_hash() == reference.get_current_hash());
+                REQUIRE(!hasher.can_slide());
+            }
+            THEN("Sliding past the end of the string fails")
+            {
+                auto one_more = uint64_t{};
+                REQUIRE_THROWS(hasher.slide_many(std::span{ &one_more, 1 }));
+            }
+        }
+        WHEN("We feed the bytes after the first window to an owned window")
+        {
+            auto hasher = RollingHash(policy, std::string_view{ input }.substr(0, window_size));
+            auto output = std::vector<uint64_t>(std::size(expected));
+            hasher.slide_many(std::string_view{ input }.substr(window_size), output);
+            THEN("We get the same hashes as sliding one byte at a time")
+            {
+                REQUIRE(output == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Several rolling hashes sliding in lockstep")
+{
+    GIVEN("A string with bytes from the whole range, of several lengths")
+    {
+        const auto input = make_long_string(1'000);
+        const auto window_size = std::size_t{ 16 };
+        // Lengths where windows are left over by the lanes, and too short for all lanes
+        const auto length = GENERATE(std::size_t{ 16 }, std::size_t{ 40 }, std::size_t{ 131 }, std::size_t{ 1'000 });
+        const auto prefix = std::string_view{ input }.substr(0, length);
+
+        auto require_same_hashes = [&](auto policy)
+        {
+            auto expected = std::vector<uint64_t>{};
+            auto reference = RollingHash(policy, prefix, 0);
+            expected.push_back(reference.get_current_hash());
+            while (reference.can_slide())
+            {
+                reference.slide_window();
+                expected.push_back(reference.get_current_hash());
+            }
+
+            auto output = std::vector<uint64_t>(std::size(expected));
+            hash_windows_interleaved<1>(policy, prefix, std::span{ output });
+            REQUIRE(output == expected);
+            hash_windows_interleaved<3>(policy, prefix, std::span{ output });
+            REQUIRE(output == expected);
+            hash_windows_interleaved<8>(policy, prefix, std::span{ output });
+            REQUIRE(output == expected);
+            hash_windows(policy, prefix, std::span{ output });
+            REQUIRE(output == expected);
+        };
+
+        WHEN("We hash every window with several lanes")
+        {
+            THEN("We get the same hashes as sliding a single window")
+            {
+                require_same_hashes(PolynomialHash(257, PolynomialHash::mersenne_modulo, window_size));
+                require_same_hashes(FixedWindowPolynomialHash<257, 16>{});
+                require_same_hashes(Buzhash(window_size));
+                require_same_hashes(RabinFingerprint(RabinFingerprint::default_polynomial, window_size));
+                require_same_hashes(DoublePolynomialHash(window_size));
+                require_same_hashes(Crc32cHash(window_size));
+            }
+        }
+        WHEN("The output does not have one element per window")
+        {
+            auto output = std::vector<uint64_t>(length);
+            THEN("It fails")
+            {
+                REQUIRE_THROWS(hash_windows(Buzhash(window_size), prefix, std::span{ output }));
+            }
+        }
+    }
+}
+
+TEST_CASE("Rolling hash modulo the Mersenne prime 2^61 - 1")
+{
+    GIVEN("A string with bytes from the whole range and a window size")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        const auto base = uint64_t{ 257 };
+        const auto modulo = PolynomialHash::mersenne_modulo;
+        WHEN("We slide through the whole string")
+        {
+            auto hasher = RollingHash(base, modulo, window_size, input, 0);
+            THEN("Every hash is the polynomial hash of the window, computed with plain 128-bit arithmetic")
+            {
+                __extension__ using UInt128 = unsigned __int128;
+                for (std::size_t start = 0;; ++start)
+                {
+                    auto expected = UInt128{};
+                    for (std::size_t i = start; i < start + window_size; ++i)
+                        expected = (expected * base + static_cast<unsigned char>(input.at(i))) % modulo;
+                    REQUIRE(hasher.get_current_hash() == static_cast<uint64_t>(expected));
+                    if (!hasher.can_slide())
+                        break;
+                    hasher.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Rolling hash modulo primes chosen at runtime")
+{
+    GIVEN("A string with bytes from the whole range, a window size and a modulo")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        const auto base = uint64_t{ 257 };
+        // From just above the base to just below 2^32
+        const auto modulo = GENERATE(uint64_t{ 263 }, uint64_t{ 65'537 }, uint64_t{ 1'000'000'007 },
+                                     uint64_t{ 2'147'483'647 }, uint64_t{ 4'294'967'291 });
+        WHEN("We slide through the whole string")
+        {
+            auto hasher = RollingHash(base, modulo, window_size, input, 0);
+            THEN("Every hash is the polynomial hash of the window, computed with plain divisions")
+            {
+                for (std::size_t start = 0;; ++start)
+                {
+                    auto expected = uint64_t{};
+                    for (std::size_t i = start; i < start + window_size; ++i)
+                        expected = (expected * base + static_cast<unsigned char>(input.at(i))) % modulo;
+                    REQUIRE(hasher.get_current_hash() == expected);
+                    if (!hasher.can_slide())
+                        break;
+                    hasher.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Rolling hash modulo primes of 2^32 or more")
+{
+    GIVEN("A string with bytes from the whole range, a window size and a modulo")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        const auto base = uint64_t{ 257 };
+        // From just above 2^32 to just below 2^62, where products no longer fit in 64 bits
+        const auto modulo = GENERATE(uint64_t{ 4'294'967'311 }, uint64_t{ 1'000'000'000'039 },
+                                     (uint64_t{ 1 } << 55) - 55, (uint64_t{ 1 } << 62) - 57);
+        WHEN("We slide through the whole string")
+        {
+            auto hasher = RollingHash(base, modulo, window_size, input, 0);
+            THEN("Every hash is the polynomial hash of the window, computed with plain 128-bit arithmetic")
+            {
+                __extension__ using UInt128 = unsigned __int128;
+                for (std::size_t start = 0;; ++start)
+                {
+                    auto expected = UInt128{};
+                    for (std::size_t i = start; i < start + window_size; ++i)
+                        expected = (expected * base + static_cast<unsigned char>(input.at(i))) % modulo;
+                    REQUIRE(hasher.get_current_hash() == static_cast<uint64_t>(expected));
+                    if (!hasher.can_slide())
+                        break;
+                    hasher.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Polynomial hash with the window size known at compile time")
+{
+    GIVEN("A string with bytes from the whole range")
+    {
+        const auto input = make_long_string(10'000);
+        const auto base = uint64_t{ 257 };
+        const auto modulo = PolynomialHash::mersenne_modulo;
+
+        auto require_same_hashes = [&](auto fixed_window_policy)
+        {
+            const auto window_size = fixed_window_policy.get_window_size();
+            auto hasher = RollingHash(fixed_window_policy, input, 0);
+            auto reference = RollingHash(base, modulo, window_size, input, 0);
+            while (true)
+            {
+                REQUIRE(hasher.get_current_hash() == reference.get_current_hash());
+                if (!hasher.can_slide())
+                    break;
+                hasher.slide_window();
+                reference.slide_window();
+            }
+            REQUIRE(!reference.can_slide());
+        };
+
+        WHEN("We slide through the whole string")
+        {
+            THEN("Every hash is the same as with the window size known at runtime")
+            {
+                require_same_hashes(FixedWindowPolynomialHash<257, 8>{});
+                require_same_hashes(FixedWindowPolynomialHash<257, 512>{});
+                require_same_hashes(FixedWindowPolynomialHash<257, 8192>{});
+            }
+        }
+    }
+}
+
+TEST_CASE("rsync rolling checksum")
+{
+    GIVEN("A string with bytes from the whole range and a window size")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        WHEN("We slide through the whole string")
+        {
+            auto owned = RollingHash(RollingChecksum(window_size), std::string_view{ input }.substr(0, window_size));
+            auto viewed = RollingHash(RollingChecksum(window_size), input, 0);
+            THEN("Every checksum is the pair of sums of the window, computed from scratch")
+            {
+                for (std::size_t start = 0;; ++start)
+                {
+                    auto a = uint32_t{};
+                    auto b = uint32_t{};
+                    for (std::size_t i = start; i < start + window_size; ++i)
+                    {
+                        const auto value = static_cast<uint32_t>(static_cast<unsigned char>(input.at(i)));
+                        a += value;
+                        b += static_cast<uint32_t>(start + window_size - i) * value;
+                    }
+                    const auto expected = (static_cast<uint64_t>(b) << 32) | a;
+                    REQUIRE(owned.get_current_hash() == expected);
+                    REQUIRE(viewed.get_current_hash() == expected);
+                    if (!viewed.can_slide())
+                        break;
+                    owned.slide_window(input.at(start + window_size));
+                    viewed.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Reconstruct file using each weak hash")
+{
+    GIVEN("Two similar strings")
+    {
+        using namespace std::string_literals;
+        const auto left_string = "ABCDEFGH"s;
+        const auto right_string = "CDEFABCDGHZYABC"s;
+        const auto chunk_size = std::size_t{ 3 };
+        const auto weak_hash =
+            GENERATE(FileDiff::WeakHash::rsync, FileDiff::WeakHash::buzhash, FileDiff::WeakHash::rabin,
+                     FileDiff::WeakHash::double_polynomial, FileDiff::WeakHash::crc32c);
+        WHEN("We want to update left to equal right")
+        {
+            const auto signature_from_left = FileDiff::compute_signature(left_string, chunk_size, weak_hash);
+            const auto delta_from_right = FileDiff::compute_delta(right_string, signature_from_left, chunk_size);
+            THEN("The signature records the weak hash")
+            {
+                REQUIRE(signature_from_left.weak_hash == weak_hash);
+                REQUIRE(signature_from_left != FileDiff::compute_signature(left_string, chunk_size));
+            }
+            THEN("The delta finds the same chunks as with the default weak hash")
+            {
+                REQUIRE(delta_from_right == "bC@1@0bDbGbHbZbY@0");
+            }
+            THEN("The result is equal to the file")
+            {
+                const auto result = FileDiff::apply_delta(left_string, delta_from_right, chunk_size);
+                REQUIRE(result == right_string);
+            }
+        }
+    }
+}
+
+TEST_CASE("Reconstruct file using each strong hash")
+{
+    GIVEN("Two similar strings")
+    {
+        using namespace std::string_literals;
+        const auto left_string = "ABCDEFGH"s;
+        const auto right_string = "CDEFABCDGHZYABC"s;
+        const auto chunk_size = std::size_t{ 3 };
+        const auto strong_hash = GENERATE(FileDiff::StrongHash::std_hash, FileDiff::StrongHash::xxh3_128);
+        const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size, strong_hash);
+        WHEN("We want to update left to equal right")
+        {
+            const auto signature_from_left = FileDiff::compute_signature(left_string, context);
+            const auto delta_from_right = FileDiff::compute_delta(right_string, signature_from_left, chunk_size);
+            THEN("The signature records the strong hash, and the delta uses it")
+            {
+                REQUIRE(signature_from_left.strong_hash == strong_hash);
+                REQUIRE(FileDiff::strong_hash_from_string(FileDiff::strong_hash_to_string(strong_hash)) == strong_hash);
+                REQUIRE(delta_from_right == "bC@1@0bDbGbHbZbY@0");
+                REQUIRE(FileDiff::apply_delta(left_string, delta_from_right, chunk_size) == right_string);
+            }
+            THEN("Computing the delta with a context using another strong hash fails")
+            {
+                const auto other_strong_hash = strong_hash == FileDiff::StrongHash::std_hash
+                                                   ? FileDiff::StrongHash::xxh3_128
+                                                   : FileDiff::StrongHash::std_hash;
+                const auto other_context =
+                    FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size, other_strong_hash);
+                REQUIRE_THROWS(FileDiff::compute_delta(right_string, signature_from_left, other_context));
+            }
+        }
+    }
+    GIVEN("An empty string")
+    {
+        WHEN("We compute its signature with XXH3")
+        {
+            const auto signature = FileDiff::compute_signature("", std::size_t{ 3 });
+            THEN("Its only chunk has the reference 128-bit XXH3 of no bytes, the same with any compiler")
+            {
+                REQUIRE(signature.strong_hash == FileDiff::StrongHash::xxh3_128);
+                const auto expected = FileDiff::Digest{ 0x6001'C324'468D'497F, 0x99AA'06D3'0147'98D8 };
+                REQUIRE(signature.strong_hashes.at(0) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Hash context shared across calls")
+{
+    GIVEN("A hash context and a few strings")
+    {
+        using namespace std::string_literals;
+        const auto chunk_size = std::size_t{ 3 };
+        const auto weak_hash =
+            GENERATE(FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync, FileDiff::WeakHash::buzhash,
+                     FileDiff::WeakHash::rabin, FileDiff::WeakHash::double_polynomial, FileDiff::WeakHash::crc32c);
+        const auto context = FileDiff::HashContext(weak_hash, chunk_size);
+        const auto strings = std::vector{ ""s, "AB"s, "ABCDEFGH"s, "CDEFABCDGHZYABC"s };
+        WHEN("We compute signatures and deltas with it")
+        {
+            THEN("They are the same as when building everything for each call")
+            {
+                for (const auto& basis : strings)
+                {
+                    const auto signature = FileDiff::compute_signature(basis, context);
+                    REQUIRE(signature == FileDiff::compute_signature(basis, chunk_size, weak_hash));
+                    for (const auto& other : strings)
+                    {
+                        const auto delta = FileDiff::compute_delta(other, signature, context);
+                        REQUIRE(delta == FileDiff::compute_delta(other, signature, chunk_size));
+                        REQUIRE(FileDiff::apply_delta(basis, delta, chunk_size) == other);
+                    }
+                }
+            }
+        }
+        WHEN("The signature was computed with another weak hash")
+        {
+            const auto other_weak_hash = weak_hash == FileDiff::WeakHash::rsync ? FileDiff::WeakHash::rabin
+                                                                                : FileDiff::WeakHash::rsync;
+            const auto signature = FileDiff::compute_signature("ABCDEFGH"s, chunk_size, other_weak_hash);
+            THEN("Computing the delta with the context fails")
+            {
+                REQUIRE_THROWS(FileDiff::compute_delta("ABCDEFGH"s, signature, context));
+            }
+        }
+    }
+}
+
+TEST_CASE("Delta computed with several threads")
+{
+    GIVEN("A basis string and a long edited version of it")
+    {
+        // Long enough for the windows to be split across several threads
+        const auto basis = make_long_string(300'000);
+        auto edited = basis;
+        edited.insert(1'000, "inserted");
+        edited.erase(150'000, 100);
+        edited[250'000] = '!';
+
+        const auto chunk_size = std::size_t{ 64 };
+        const auto weak_hash =
+            GENERATE(FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync, FileDiff::WeakHash::buzhash,
+                     FileDiff::WeakHash::rabin, FileDiff::WeakHash::double_polynomial, FileDiff::WeakHash::crc32c);
+        const auto threads = GENERATE(std::size_t{ 2 }, std::size_t{ 3 }, std::size_t{ 8 });
+        WHEN("We compute the delta with several threads")
+        {
+            const auto signature = FileDiff::compute_signature(basis, chunk_size, weak_hash);
+            const auto delta = FileDiff::compute_delta(edited, signature, chunk_size, threads);
+            THEN("It is the same as the serial delta")
+            {
+                REQUIRE(delta == FileDiff::compute_delta(edited, signature, chunk_size));
+                REQUIRE(FileDiff::apply_delta(basis, delta, chunk_size) == edited);
+            }
+        }
+    }
+}
+
+TEST_CASE("Signature computed with several threads")
+{
+    GIVEN("A long string")
+    {
+        // Long enough for the chunks to be split across several threads
+        const auto input = make_long_string(300'000);
+
+        const auto chunk_size = std::size_t{ 64 };
+        const auto weak_hash =
+            GENERATE(FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync, FileDiff::WeakHash::buzhash,
+                     FileDiff::WeakHash::rabin, FileDiff::WeakHash::double_polynomial, FileDiff::WeakHash::crc32c);
+        const auto chunking = GENERATE(FileDiff::Chunking::fixed, FileDiff::Chunking::cdc);
+        const auto threads = GENERATE(std::size_t{ 2 }, std::size_t{ 3 }, std::size_t{ 8 });
+        WHEN("We compute the signature with several threads")
+        {
+            const auto signature = FileDiff::compute_signature(input, chunk_size, weak_hash, chunking, threads);
+            THEN("It is the same as the serial signature")
+            {
+                REQUIRE(signature == FileDiff::compute_signature(input, chunk_size, weak_hash, chunking));
+            }
+        }
+    }
+}
+
+TEST_CASE("Signature streamed from an input stream")
+{
+    GIVEN("Inputs of a few sizes, up to several buffers of the streaming signature")
+    {
+        const auto size = GENERATE(std::size_t{ 0 }, std::size_t{ 1'000 }, FileDiff::signature_buffer_size,
+                                   FileDiff::signature_buffer_size * 5 / 2);
+        auto input = make_long_string(size);
+        for (std::size_t i = 0; i < size; i += 61)
+            input[i] = '\n';
+        const auto chunking =
+            GENERATE(FileDiff::Chunking::fixed, FileDiff::Chunking::cdc, FileDiff::Chunking::lines);
+        const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, 4096);
+        WHEN("We stream its signature, a buffer at a time")
+        {
+            auto stream = std::istringstream{ input };
+            auto streamed = FileDiff::Signature{};
+            auto buffers = std::size_t{};
+            const auto header = FileDiff::compute_signature(
+                stream, context, chunking,
+                [&streamed, &buffers](const FileDiff::Signature& chunks)
+                {
+                    ++buffers;
+                    streamed.rolling_hashes.insert(std::end(streamed.rolling_hashes), std::begin(chunks.rolling_hashes),
+                                                   std::end(chunks.rolling_hashes));
+                    streamed.strong_hashes.insert(std::end(streamed.strong_hashes), std::begin(chunks.strong_hashes),
+                                                  std::end(chunks.strong_hashes));
+                    streamed.chunk_lengths.insert(std::end(streamed.chunk_lengths), std::begin(chunks.chunk_lengths),
+                                                  std::end(chunks.chunk_lengths));
+                });
+            THEN("It is the same as the signature of the whole input")
+            {
+                streamed.weak_hash = header.weak_hash;
+                streamed.chunking = header.chunking;
+                streamed.chunk_size = header.chunk_size;
+                streamed.tail_length = header.tail_length;
+                REQUIRE(streamed == FileDiff::compute_signature(input, context, chunking));
+                REQUIRE(buffers <= size / FileDiff::signature_buffer_size + 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Signature streamed with a chunk starting a maximum chunk size before the end of a buffer")
+{
+    GIVEN("An input whose chunks are all of the maximum size, up to one a maximum chunk size before the end of the "
+          "first buffer, which has a single line break")
+    {
+        // 64-byte chunks, so that the buffer is exactly `signature_buffer_size` bytes
+        const auto chunk_size = std::size_t{ 64 };
+        const auto chunking = GENERATE(FileDiff::Chunking::cdc, FileDiff::Chunking::lines);
+        const auto maximum_size = chunking == FileDiff::Chunking::cdc
+                                      ? fastcdc::make_parameters(chunk_size).maximum_size
+                                      : line_chunking::make_parameters(chunk_size).maximum_size;
+        const auto minimum_size = chunking == FileDiff::Chunking::cdc
+                                      ? fastcdc::make_parameters(chunk_size).minimum_size
+                                      : line_chunking::make_parameters(chunk_size).minimum_size;
+        const auto boundary = FileDiff::signature_buffer_size - maximum_size;
+        // The Gear hash of this repeated byte (unlike most) never cuts, so the chunks are cut at the maximum size.
+        // The line break comes with no cut after it, so with lines the chunk is cut right after it, seeing the bytes
+        // after the buffer. Only seeing the buffer, it would be the maximum size instead.
+        auto input = std::string(FileDiff::signature_buffer_size + 1'000, 'x');
+        input[boundary + minimum_size] = '\n';
+        const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size);
+        const auto signature = FileDiff::compute_signature(input, context, chunking);
+        auto chunk_start = std::size_t{};
+        for (std::size_t i = 0; i < std::size(signature.chunk_lengths) && chunk_start < boundary; ++i)
+            chunk_start += signature.chunk_lengths[i];
+        REQUIRE(chunk_start == boundary);
+        WHEN("We stream its signature")
+        {
+            auto stream = std::istringstream{ input };
+            auto streamed = FileDiff::Signature{};
+            const auto header = FileDiff::compute_signature(
+                stream, context, chunking,
+                [&streamed](const FileDiff::Signature& chunks)
+                {
+                    streamed.strong_hashes.insert(std::end(streamed.strong_hashes), std::begin(chunks.strong_hashes),
+                                                  std::end(chunks.strong_hashes));
+                    streamed.chunk_lengths.insert(std::end(streamed.chunk_lengths), std::begin(chunks.chunk_lengths),
+                                                  std::end(chunks.chunk_lengths));
+                });
+            THEN("It has the same chunks as the whole input")
+            {
+                streamed.weak_hash = header.weak_hash;
+                streamed.chunking = header.chunking;
+                streamed.chunk_size = header.chunk_size;
+                auto lengths = std::vector<std::size_t>{};
+                for (const auto chunk : FileDiff::get_chunk_views(input, chunk_size, chunking))
+                    lengths.push_back(std::size(chunk));
+                REQUIRE(streamed.chunk_lengths == lengths);
+                REQUIRE(streamed == signature);
+            }
+        }
+    }
+}
+
+TEST_CASE("Automatic chunk size")
+{
+    GIVEN("Inputs of various sizes")
+    {
+        WHEN("We pick their chunk size")
+        {
+            THEN("It is the square root of their size, rounded down to a power of two, within the bounds")
+            {
+                REQUIRE(FileDiff::get_automatic_chunk_size(0) == FileDiff::minimum_automatic_chunk_size);
+                REQUIRE(FileDiff::get_automatic_chunk_size(1'000) == FileDiff::minimum_automatic_chunk_size);
+                REQUIRE(FileDiff::get_automatic_chunk_size(std::size_t{ 1 } << 20) == 1024);
+                REQUIRE(FileDiff::get_automatic_chunk_size((std::size_t{ 1 } << 22) - 1) == 1024);
+                REQUIRE(FileDiff::get_automatic_chunk_size(std::size_t{ 1 } << 22) == 2048);
+                REQUIRE(FileDiff::get_automatic_chunk_size(10'000'000'000) == 65536);
+                REQUIRE(FileDiff::get_automatic_chunk_size(std::size_t{ 1 } << 50) ==
+                        FileDiff::maximum_automatic_chunk_size);
+            }
+        }
+    }
+    GIVEN("A basis string and an edited version of it")
+    {
+        const auto basis = make_long_string(300'000);
+        auto edited = basis;
+        edited.insert(1'000, "inserted");
+        edited[250'000] = '!';
+        const auto chunk_size = FileDiff::get_automatic_chunk_size(std::size(basis));
+        WHEN("We compute the signature with the automatic chunk size")
+        {
+            const auto signature = FileDiff::compute_signature(basis, chunk_size);
+            THEN("The signature records it, and the delta with it reconstructs the edited string")
+            {
+                REQUIRE(signature.chunk_size == chunk_size);
+                const auto delta = FileDiff::compute_delta(edited, signature, signature.chunk_size);
+                REQUIRE(FileDiff::apply_delta(basis, delta, chunk_size) == edited);
+            }
+            THEN("Computing the delta with another chunk size fails")
+            {
+                REQUIRE_THROWS(FileDiff::compute_delta(edited, signature, chunk_size / 2));
+            }
+        }
+    }
+}
+
+TEST_CASE("Content-defined chunks")
+{
+    GIVEN("A pseudo-random string, and an edited version of it")
+    {
+        auto basis = std::string{};
+        auto state = uint64_t{ 42 };
+        for (auto i = 0; i < 100'000; ++i)
+        {
+            state = state * 6364136223846793005 + 1442695040888963407;
+            basis.push_back(static_cast<char>(state >> 56));
+        }
+        auto edited = basis;
+        edited.insert(50'000, "inserted");
+        const auto parameters = fastcdc::make_parameters(256);
+        WHEN("We cut both into chunks")
+        {
+            const auto basis_lengths = fastcdc::split(basis, parameters);
+            const auto edited_lengths = fastcdc::split(edited, parameters);
+            THEN("The chunks cover the whole string, and only the last one is outside the size limits")
+            {
+                auto total = std::size_t{};
+                for (std::size_t i = 0; i < std::size(basis_lengths); ++i)
+                {
+                    if (i + 1 < std::size(basis_lengths))
+                        REQUIRE(basis_lengths[i] >= parameters.minimum_size);
+                    REQUIRE(basis_lengths[i] <= parameters.maximum_size);
+                    total += basis_lengths[i];
+                }
+                REQUIRE(total == std::size(basis));
+                // About the average size on random data
+                REQUIRE(std::size(basis_lengths) > std::size(basis) / 512);
+                REQUIRE(std::size(basis_lengths) < std::size(basis) / 128);
+            }
+            THEN("Only the chunks around the edit change")
+            {
+                auto common_prefix = std::size_t{};
+                while (basis_lengths[common_prefix] == edited_lengths[common_prefix])
+                    ++common_prefix;
+                auto common_suffix = std::size_t{};
+                while (basis_lengths[std::size(basis_lengths) - 1 - common_suffix] ==
+                       edited_lengths[std::size(edited_lengths) - 1 - common_suffix])
+                    ++common_suffix;
+                // The chunk with the edit, and a few after it: the minimum size and the masks count from the start
+                // of the chunk, so it can take a few chunks to cut at the same places again
+                REQUIRE(std::size(basis_lengths) - common_prefix - common_suffix <= 5);
+            }
+        }
+        WHEN("We compute the delta with content-defined chunks")
+        {
+            const auto chunk_size = std::size_t{ 256 };
+            const auto weak_hash =
+                GENERATE(FileDiff::WeakHash::polynomial, FileDiff::WeakHash::rsync, FileDiff::WeakHash::buzhash,
+                         FileDiff::WeakHash::rabin, FileDiff::WeakHash::double_polynomial, FileDiff::WeakHash::crc32c);
+            const auto signature =
+                FileDiff::compute_signature(basis, chunk_size, weak_hash, FileDiff::Chunking::cdc);
+            auto statistics = FileDiff::DeltaStatistics{};
+            const auto delta = FileDiff::compute_delta(edited, signature,
+                                                       FileDiff::HashContext(weak_hash, chunk_size), 1, &statistics);
+            THEN("The signature records the chunks, and the delta rebuilds the edited string from most of them")
+            {
+                REQUIRE(signature.chunk_lengths == fastcdc::split(basis, fastcdc::make_parameters(chunk_size)));
+                REQUIRE(FileDiff::apply_delta(basis, delta, chunk_size, FileDiff::Chunking::cdc) == edited);
+                REQUIRE(statistics.false_weak_matches == 0);
+                // The literals are the chunks around the edit, at most a few maximum-sized chunks
+                const auto literals = static_cast<std::size_t>(std::count(std::begin(delta), std::end(delta), 'b'));
+                REQUIRE(literals < 4 * 4 * chunk_size);
+            }
+        }
+    }
+    GIVEN("A short string")
+    {
+        const auto input = std::string{ "Whatever our souls are made of, his and mine are the same." };
+        THEN("Its content-defined chunks add up to it")
+        {
+            auto joined = std::string{};
+            for (const auto& chunk : FileDiff::split_into_variable_length_chunks(input, 8, FileDiff::Chunking::cdc))
+                joined += chunk;
+            REQUIRE(joined == input);
+        }
+    }
+}
+
+TEST_CASE("Line-aware chunks")
+{
+    GIVEN("Strings of every length up to a few vector blocks, with newlines here and there")
+    {
+        THEN("The newline scans find the same newlines as searching one byte at a time")
+        {
+            for (std::size_t length = 0; length < 70; ++length)
+            {
+                for (std::size_t newline_every = 1; newline_every < 40; newline_every += 6)
+                {
+                    auto input = std::string(length, 'x');
+                    for (auto i = newline_every / 2; i < length; i += newline_every)
+                        input[i] = '\n';
+                    const auto view = std::string_view{ input };
+                    REQUIRE(line_chunking::find_first_newline(view) == view.find('\n'));
+                    REQUIRE(line_chunking::find_last_newline(view) == view.rfind('\n'));
+                }
+            }
+        }
+    }
+    GIVEN("Lines of text, and the same text with a line edited")
+    {
+        auto text = std::string{};
+        for (auto i = 0; i < 2'000; ++i)
+        {
+            const auto padding = std::string(static_cast<std::size_t>(i % 37), '.');
+            text += "line " + std::to_string(i * 7919 % 10'007) + padding + '\n';
+        }
+        auto edited = text;
+        edited.insert(edited.find("\n", 30'000) + 1, "a new line\n");
+        const auto chunk_size = std::size_t{ 256 };
+        const auto parameters = line_chunking::make_parameters(chunk_size);
+        WHEN("We cut the text into chunks")
+        {
+            const auto lengths = line_chunking::split(text, parameters);
+            THEN("Every chunk but the last ends with a newline")
+            {
+                auto start = std::size_t{};
+                for (std::size_t i = 0; i + 1 < std::size(lengths); ++i)
+                {
+                    REQUIRE(lengths[i] <= parameters.maximum_size);
+                    start += lengths[i];
+                    REQUIRE(text[start - 1] == '\n');
+                }
+                REQUIRE(start + lengths.back() == std::size(text));
+            }
+        }
+        WHEN("We compute the delta with line-aware and with fixed chunks")
+        {
+            const auto signature = FileDiff::compute_signature(text, chunk_size, FileDiff::WeakHash::polynomial,
+                                                               FileDiff::Chunking::lines);
+            const auto delta = FileDiff::compute_delta(edited, signature, chunk_size);
+            const auto fixed_delta = FileDiff::compute_delta(
+                edited, FileDiff::compute_signature(text, chunk_size, FileDiff::WeakHash::polynomial), chunk_size);
+            THEN("The delta rebuilds the edited text, with fewer literal bytes than with fixed chunks")
+            {
+                REQUIRE(FileDiff::apply_delta(text, delta, chunk_size, FileDiff::Chunking::lines) == edited);
+                const auto literals = std::count(std::begin(delta), std::end(delta), 'b');
+                REQUIRE(literals < std::count(std::begin(fixed_delta), std::end(fixed_delta), 'b'));
+            }
+        }
+    }
+    GIVEN("A line longer than the maximum chunk size, with a single line break early on")
+    {
+        const auto parameters = line_chunking::make_parameters(64);
+        // The Gear hash of this repeated byte never cuts, so the chunk is cut back at the line break
+        auto input = std::string(parameters.maximum_size, 'x');
+        input[parameters.minimum_size] = '\n';
+        WHEN("We cut a chunk from exactly the maximum chunk size, and from more")
+        {
+            const auto length = line_chunking::find_chunk_end(input, parameters);
+            THEN("Both chunks end at the line break")
+            {
+                REQUIRE(length == parameters.minimum_size + 1);
+                REQUIRE(line_chunking::find_chunk_end(input + std::string(100, 'x'), parameters) == length);
+            }
+        }
+    }
+}
+
+TEST_CASE("Buzhash")
+{
+    GIVEN("A string with bytes from the whole range and a window size")
+    {
+        const auto input = make_whole_range_string();
+        // Bigger than 64, so that rotations wrap around
+        const auto window_size = std::size_t{ 70 };
+        WHEN("We slide through the whole string")
+        {
+            auto owned = RollingHash(Buzhash(window_size), std::string_view{ input }.substr(0, window_size));
+            auto viewed = RollingHash(Buzhash(window_size), input, 0);
+            THEN("Every hash is the same as if computed from scratch")
+            {
+                for (std::size_t start = 0;; ++start)
+                {
+                    const auto window = std::string_view{ input }.substr(start, window_size);
+                    const auto from_scratch = RollingHash(Buzhash(window_size), window).get_current_hash();
+                    REQUIRE(owned.get_current_hash() == from_scratch);
+                    REQUIRE(viewed.get_current_hash() == from_scratch);
+                    if (!viewed.can_slide())
+                        break;
+                    owned.slide_window(input.at(start + window_size));
+                    viewed.slide_window();
+                }
+            }
+        }
+        WHEN("Two windows have the same bytes in a different order")
+        {
+            const auto left = RollingHash(Buzhash(4), "ABCD").get_current_hash();
+            const auto right = RollingHash(Buzhash(4), "DCBA").get_current_hash();
+            THEN("Their hashes are different")
+            {
+                REQUIRE(left != right);
+            }
+        }
+    }
+}
+
+TEST_CASE("Rabin fingerprint")
+{
+    GIVEN("A string with bytes from the whole range and a window size")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        const auto polynomial = RabinFingerprint::default_polynomial;
+        WHEN("We slide through the whole string")
+        {
+            const auto policy = RabinFingerprint(polynomial, window_size);
+            auto owned = RollingHash(policy, std::string_view{ input }.substr(0, window_size));
+            auto viewed = RollingHash(policy, input, 0);
+            THEN("Every fingerprint is the window's bits modulo the polynomial, computed one bit at a time")
+            {
+                for (std::size_t start = 0;; ++start)
+                {
+                    auto expected = uint64_t{};
+                    for (std::size_t i = start; i < start + window_size; ++i)
+                    {
+                        for (auto bit = 7; bit >= 0; --bit)
+                        {
+                            expected = (expected << 1) | ((static_cast<unsigned char>(input.at(i)) >> bit) & 1);
+                            if (expected >> 53)
+                                expected ^= polynomial;
+                        }
+                    }
+                    REQUIRE(owned.get_current_hash() == expected);
+                    REQUIRE(viewed.get_current_hash() == expected);
+                    if (!viewed.can_slide())
+                        break;
+                    owned.slide_window(input.at(start + window_size));
+                    viewed.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Double polynomial hash")
+{
+    GIVEN("A string with bytes from the whole range and a window size")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 16 };
+        WHEN("We slide through the whole string")
+        {
+            auto hasher = RollingHash(DoublePolynomialHash(window_size), input, 0);
+            THEN("Each half of every hash is the polynomial hash of the window modulo its own prime")
+            {
+                auto polynomial_hash = [&](std::size_t start, uint64_t base, uint64_t modulo)
+                {
+                    auto result = uint64_t{};
+                    for (std::size_t i = start; i < start + window_size; ++i)
+                        result = (result * base + static_cast<unsigned char>(input.at(i))) % modulo;
+                    return result;
+                };
+                for (std::size_t start = 0;; ++start)
+                {
+                    const auto hash = hasher.get_current_hash();
+                    REQUIRE((hash & 0xFFFF'FFFF) == polynomial_hash(start, DoublePolynomialHash::first_base,
+                                                                     DoublePolynomialHash::first_modulo));
+                    REQUIRE((hash >> 32) == polynomial_hash(start, DoublePolynomialHash::second_base,
+                                                            DoublePolynomialHash::second_modulo));
+                    if (!hasher.can_slide())
+                        break;
+                    hasher.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("CRC-32C hash")
+{
+    GIVEN("A string with bytes from the whole range and a window size that is not a multiple of 8")
+    {
+        const auto input = make_whole_range_string();
+        const auto window_size = std::size_t{ 13 };
+        // CRC-32C of the window, one bit at a time, without the initial and final inversions
+        auto crc = [&](std::size_t start)
+        {
+            auto result = uint64_t{};
+            for (std::size_t i = start; i < start + window_size; ++i)
+            {
+                result ^= static_cast<unsigned char>(input.at(i));
+                for (auto bit = 0; bit < 8; ++bit)
+                    result = (result >> 1) ^ ((result & 1) != 0 ? Crc32cHash::polynomial : 0);
+            }
+            return result;
+        };
+        WHEN("We slide through the whole string, with and without the crc32 instruction")
+        {
+            const auto hardware = GENERATE(false, true);
+            const auto policy = Crc32cHash(window_size, hardware);
+            auto hasher = RollingHash(policy, input, 0);
+            THEN("Every hash is the CRC of the window computed one bit at a time")
+            {
+                for (std::size_t start = 0;; ++start)
+                {
+                    REQUIRE(hasher.get_current_hash() == crc(start));
+                    REQUIRE(policy.hash_window(std::string_view{ input }.substr(start, window_size)) == crc(start));
+                    if (!hasher.can_slide())
+                        break;
+                    hasher.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Delta statistics")
+{
+    GIVEN("A signature and a string made of some of its chunks and other bytes")
+    {
+        using namespace std::string_literals;
+        const auto basis = "ABCDEFGH"s;
+        const auto other = "CDEFABCDGHZYABC"s;
+        const auto chunk_size = std::size_t{ 3 };
+        const auto context = FileDiff::HashContext(FileDiff::WeakHash::polynomial, chunk_size);
+        const auto signature = FileDiff::compute_signature(basis, context);
+        WHEN("We compute the delta")
+        {
+            auto statistics = FileDiff::DeltaStatistics{};
+            const auto delta = FileDiff::compute_delta(other, signature, context, 1, &statistics);
+            THEN("Every matched chunk was verified with the strong hash, and there were no collisions")
+            {
+                REQUIRE(delta == "bC@1@0bDbGbHbZbY@0");
+                REQUIRE(statistics.bytes == std::size(other));
+                REQUIRE(statistics.strong_hash_verifications == 3);
+                REQUIRE(statistics.false_weak_matches == 0);
+                REQUIRE(statistics.verifications_per_megabyte() == Approx(3e6 / 15));
+            }
+        }
+    }
+}
+
+TEST_CASE("Runtime choice of the instruction set")
+{
+    using cpu_dispatch::IsaLevel;
+    GIVEN("The ISA levels, from the most portable one")
+    {
+        const auto levels = { IsaLevel::baseline, IsaLevel::x86_64_v2, IsaLevel::x86_64_v3, IsaLevel::x86_64_v4 };
+        THEN("Each level is named, and read back from its name")
+        {
+            for (const auto level : levels)
+                REQUIRE(cpu_dispatch::isa_level_from_string(cpu_dispatch::isa_level_to_string(level)) == level);
+            REQUIRE_THROWS(cpu_dispatch::isa_level_from_string("x86-64-v5"));
+        }
+        THEN("A CPU supporting a level supports the ones before it")
+        {
+            auto previous_supported = true;
+            for (const auto level : levels)
+            {
+                REQUIRE((previous_supported || !cpu_dispatch::is_supported(level)));
+                previous_supported = cpu_dispatch::is_supported(level);
+            }
+        }
+        THEN("The active level is supported, and enables the baseline kernels and the chosen rsync kernel")
+        {
+            REQUIRE(cpu_dispatch::is_supported(cpu_dispatch::get_active_isa_level()));
+            REQUIRE(cpu_dispatch::is_enabled(IsaLevel::baseline));
+            REQUIRE(rolling_checksum_kernels::is_supported(rolling_checksum_kernels::best_supported_kernel()));
+        }
+    }
+}
+
+TEST_CASE("Vectorized rsync rolling checksum kernels")
+{
+    using rolling_checksum_kernels::Kernel;
+    GIVEN("A string with bytes from the whole range")
+    {
+        auto input = std::string{};
+        for (auto i = 0; i < 1000; ++i)
+            input.push_back(static_cast<char>(i * 37 + i / 7));
+        const auto kernel = GENERATE(Kernel::scalar, Kernel::sse41, Kernel::avx2, Kernel::avx512);
+        // Window sizes and lengths so that every kernel has leftover windows to process one by one
+        const auto window_size = GENERATE(std::size_t{ 1 }, std::size_t{ 3 }, std::size_t{ 30 }, std::size_t{ 997 });
+        const auto length = GENERATE(std::size_t{ 997 }, std::size_t{ 1000 });
+        const auto view = std::string_view{ input }.substr(0, length);
+        WHEN("The kernel is supported by this CPU, and we hash every window")
+        {
+            if (!rolling_checksum_kernels::is_supported(kernel))
+                return;
+            auto output = std::vector<uint64_t>(length - window_size + 1);
+            rolling_checksum_kernels::hash_all_windows(view, window_size, output, kernel);
+            THEN("Every checksum is the same as sliding one byte at a time")
+            {
+                auto hasher = RollingHash(RollingChecksum(window_size), view, 0);
+                for (const auto hash : output)
+                {
+                    REQUIRE(hash == hasher.get_current_hash());
+                    if (hasher.can_slide())
+                        hasher.slide_window();
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Signature files")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "rolling_hash_file_diff_tests.sig").string();
+    GIVEN("A long string, with a short last fixed chunk")
+    {
+        const auto input = make_long_string(300'000);
+        const auto chunk_size = std::size_t{ 64 };
+        REQUIRE(std::size(input) % chunk_size != 0);
+        const auto strong_hash = GENERATE(FileDiff::StrongHash::xxh3_128, FileDiff::StrongHash::std_hash);
+        const auto chunking =
+            GENERATE(FileDiff::Chunking::fixed, FileDiff::Chunking::cdc, FileDiff::Chunking::lines);
+        const auto context = FileDiff::HashContext(FileDiff::WeakHash::buzhash, chunk_size, strong_hash);
+        const auto signature = FileDiff::compute_signature(input, context, chunking);
+        WHEN("We save its signature and read it back")
+        {
+            io_helpers::save_signature_to_file(path, signature);
+            THEN("It is the same signature")
+            {
+                REQUIRE(io_helpers::read_signature_from_file(path) == signature);
+            }
+        }
+        WHEN("We stream its signature to the file and read it back")
+        {
+            auto stream = std::istringstream{ input };
+            io_helpers::save_signature_to_file(path, stream, context, chunking);
+            const auto content = io_helpers::read_file_to_string(path);
+            THEN("It is the same signature")
+            {
+                REQUIRE(io_helpers::read_signature_from_file(path) == signature);
+            }
+            THEN("The header records how it was computed")
+            {
+                REQUIRE(content.starts_with("weak-hash buzhash\nstrong-hash " +
+                                            FileDiff::strong_hash_to_string(strong_hash) + "\nchunking " +
+                                            FileDiff::chunking_to_string(chunking) + "\nchunk-size 64\n"));
+            }
+            THEN("The length of the short last chunk is in the trailer, with fixed chunks only")
+            {
+                const auto trailer = "\ntail-length " + std::to_string(std::size(input) % chunk_size) + "\n";
+                REQUIRE(content.ends_with(trailer) == (chunking == FileDiff::Chunking::fixed));
+            }
+            THEN("128-bit strong hashes are written as two numbers on a single line")
+            {
+                auto lines = std::istringstream{ content };
+                auto line = std::string{};
+                // Past the four header lines, the strong hash is the second line of a fixed chunk, and the first
+                // of a variable-length one
+                for (auto i = 0; i < (chunking == FileDiff::Chunking::fixed ? 6 : 5); ++i)
+                    std::getline(lines, line);
+                const auto is_wide = strong_hash == FileDiff::StrongHash::xxh3_128;
+                REQUIRE((line.find(' ') != std::string::npos) == is_wide);
+            }
+        }
+    }
+    GIVEN("A signature file without a strong-hash line, and with header fields in the trailer")
+    {
+        io_helpers::save_to_file(path, "weak-hash rsync\n"
+                                       "11\n"
+                                       "22\n"
+                                       "33\n"
+                                       "44\n"
+                                       "chunk-size 30\n"
+                                       "tail-length 7\n");
+        WHEN("We read it")
+        {
+            const auto signature = io_helpers::read_signature_from_file(path);
+            THEN("It has the std::hash strong hash of older files, and every field")
+            {
+                REQUIRE(signature.weak_hash == FileDiff::WeakHash::rsync);
+                REQUIRE(signature.strong_hash == FileDiff::StrongHash::std_hash);
+                REQUIRE(signature.chunking == FileDiff::Chunking::fixed);
+                REQUIRE(signature.chunk_size == 30);
+                REQUIRE(signature.tail_length == 7);
+                REQUIRE(signature.rolling_hashes == std::vector<FileDiff::Hash>{ 11, 33 });
+                REQUIRE(signature.strong_hashes == std::vector<FileDiff::Digest>{ { 22, 0 }, { 44, 0 } });
+            }
+        }
+    }
+    GIVEN("A signature file without a header")
+    {
+        io_helpers::save_to_file(path, "11\n22\n");
+        THEN("Reading it fails")
+        {
+            REQUIRE_THROWS_AS(io_helpers::read_signature_from_file(path), std::runtime_error);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Delta files")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "rolling_hash_file_diff_tests.delta").string();
+    GIVEN("A delta, with the chunking and chunk size of its signature")
+    {
+        // A literal new line byte, to check that the end of the header is found by the first token
+        const auto delta = FileDiff::Delta{ "@0b\nb@@12" };
+        const auto chunking =
+            GENERATE(FileDiff::Chunking::fixed, FileDiff::Chunking::cdc, FileDiff::Chunking::lines);
+        WHEN("We save it and read it back")
+        {
+            io_helpers::save_delta_to_file(path, { delta, chunking, 4096 });
+            const auto delta_file = io_helpers::read_delta_from_file(path);
+            THEN("It is the same delta, with the same chunking and chunk size")
+            {
+                REQUIRE(delta_file.delta == delta);
+                REQUIRE(delta_file.chunking == chunking);
+                REQUIRE(delta_file.chunk_size == 4096);
+            }
+        }
+    }
+    GIVEN("A delta file without a header")
+    {
+        io_helpers::save_to_file(path, "b1@0@1");
+        WHEN("We read it")
+        {
+            const auto delta_file = io_helpers::read_delta_from_file(path);
+            THEN("It is all delta, with no chunking nor chunk size")
+            {
+                REQUIRE(delta_file.delta == "b1@0@1");
+                REQUIRE_FALSE(delta_file.chunking.has_value());
+                REQUIRE(delta_file.chunk_size == 0);
+            }
+        }
+    }
+    GIVEN("A delta file with an unknown header field")
+    {
+        io_helpers::save_to_file(path, "compression none\n@0");
+        THEN("Reading it fails")
+        {
+            REQUIRE_THROWS_AS(io_helpers::read_delta_from_file(path), std::runtime_error);
+        }
+    }
+    std::filesystem::remove(path);
+}